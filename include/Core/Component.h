@@ -17,13 +17,30 @@ Defines a component of a GameObject. Derive from this to add functionality to a
 #include <SFML/Network/Packet.hpp>
 
 #include "Core/RefCounted.h"
+#include "Core/Handle.h"
+#include "Core/Symbol.h"
 
 class GameObject;
+class ComponentPoolBase;
+
+/// GameObject callbacks that components subscribe to. A component only gets the callbacks it subscribed to
+namespace ComponentCallback
+{
+    enum
+    {
+        SET_POSITION,
+        SET_ROTATION,
+        PRE_SOLVE,
+        CONTACT_BEGIN,
+        CONTACT_END,
+        COUNT
+    };
+};
 
 class Component : public RefCounted
 {
     public:
-        Component(GameObject *object, std::string name);
+        Component(GameObject *object, Symbol name);
         virtual ~Component();
 
         virtual void serialize(sf::Packet &packet);
@@ -35,6 +52,7 @@ class Component : public RefCounted
         /// Handle packets sent to this Component
         virtual void handlePacket(sf::Packet &packet){}
 
+        // Subscribe to the matching ComponentCallback when overriding these
         virtual void onSetPosition(sf::Vector2f position){} //called when the object's position is set
         virtual void onSetRotation(float rotation){} //called when the object's position is set
 
@@ -47,23 +65,82 @@ class Component : public RefCounted
         /// Called when a collision ends
         virtual void onContactEnd(GameObject *object){}
 
+        /// Called at the end of the tick the owning GameObject dies in, before it is released
+        virtual void onDestroy(){}
+
+        /// Called on clients when the owning GameObject comes into or goes out of the area around them that the
+        /// server keeps them up to date on. Out of it, the object's state is whatever it was when it left
+        virtual void onNetworkEnter(){}
+        virtual void onNetworkLeave(){}
+
+        /// Looks up a component by handle. Returns NULL if the component has been destroyed
+        static Component *get(Handle handle){return Handles.get(handle);}
+
+        /// Complains about callbacks this component overrides but didn't subscribe to, which it would never get.
+        /// Only does anything in FISSION_DEBUG builds made with GCC. GameObjects call it when the component is attached
+        void checkSubscriptions();
+
         //accessors
-        std::string getName(){return mName;}
-        std::string getTypeName(){return mTypeName;}
+        Handle getHandle(){return mHandle;}
+        GameObject *getGameObject(){return mGameObject;}
+        Symbol getName(){return mName;}
+        Symbol getTypeName(){return mTypeName;}
         bool getShouldSerialize(){return mShouldSerialize;}
+        bool getParallelSafe(){return mParallelSafe;}
+        bool getSubscribed(unsigned int callback){return (mCallbacks&(1<<callback))!=0;}
+        float getUpdateRate(){return mUpdateRate;}
+        bool getPooled(){return mPool!=NULL;}
+        unsigned int getPoolSlot(){return mPoolSlot;}
 
         //mutators
-        void setName(std::string name){mName=name;}
-        void getTypeName(std::string typeName){mTypeName=typeName;}
+        void setName(Symbol name);
+        void getTypeName(Symbol typeName){mTypeName=typeName;}
         void setShouldSerialize(bool serialize){mShouldSerialize=serialize;}
+        void setParallelSafe(bool safe){mParallelSafe=safe;}
+        void setPool(ComponentPoolBase *pool, unsigned int slot){mPool=pool;mPoolSlot=slot;}
+        void setUpdateRate(float rate){mUpdateRate=rate;}
+
+        /// Time that passed on ticks the UpdateScheduler skipped this component on
+        void addSkippedTime(float time){mSkippedTime+=time;}
+        float takeSkippedTime(){float time = mSkippedTime; mSkippedTime = 0; return time;}
 
     protected:
+        /// Returns pooled components to their pool instead of deleting them
+        virtual void destroy();
+
         GameObject *mGameObject;
-        std::string mName;
-        std::string mTypeName;
+        Symbol mName;
+        Symbol mTypeName;
         bool mShouldSerialize;
 
+        /// Whether or not update() may run on a worker thread. A parallel safe component only reads the rest of the
+        /// world and only writes to its own GameObject. Components are not parallel safe unless they say so
+        bool mParallelSafe;
+
+        /// Subscribes to a ComponentCallback. Call this from the constructor - GameObjects read subscriptions when
+        /// the component is attached
+        void subscribe(unsigned int callback){mCallbacks|=1<<callback;}
+
+        /// One bit per ComponentCallback this component is subscribed to. None by default
+        unsigned int mCallbacks;
+
+        /// Updates a second this component wants. 0, the default, updates it every tick
+        float mUpdateRate;
+
+        /// Time since the last update that wasn't passed to update() yet
+        float mSkippedTime;
+
+        /// The pool this component lives in. NULL if it was allocated with new
+        ComponentPoolBase *mPool;
+
+        /// Index of this component in its pool
+        unsigned int mPoolSlot;
+
+        /// Handle to this component that is safe to hold after it is destroyed
+        Handle mHandle;
+
     private:
+        static HandleTable <Component> Handles;
 };
 
 #endif // COMPONENT_H
@@ -0,0 +1,169 @@
+/*
+ComponentPool.h
+Theodore DeRego
+Copyright 2012
+
+Contiguous storage for components of a single type. Pooled components are updated by a loop over their pool
+instead of through their GameObject, so a whole type is updated in one pass over dense memory. Every Scene has its own
+pools, made by Scene::getPool, so scenes running on different threads never share one. The parts that need the Scene
+live in ComponentPool.cpp, so this header doesn't depend on it.
+*/
+
+#ifndef COMPONENTPOOL_H
+#define COMPONENTPOOL_H
+
+#include <utility>
+#include <vector>
+
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Mutex.hpp>
+
+#include "Core/Component.h"
+#include "Core/ComponentType.h"
+#include "Core/JobSystem.h"
+#include "Core/Slab.h"
+
+class Scene;
+class ComponentPoolBase;
+
+/// Makes an empty pool for one component type in the scene
+typedef ComponentPoolBase *(*PoolFactory)(Scene *scene);
+
+class ComponentPoolBase
+{
+    public:
+        ComponentPoolBase(Scene *scene);
+        virtual ~ComponentPoolBase();
+
+        /// Updates every component in the pool whose GameObject is alive and scheduled to update this tick. Parallel safe
+        /// ones are spread across the JobSystem
+        virtual void updateAll(float dt) = 0;
+
+        /// Destroys a component that was created by this pool and returns its slot
+        virtual void free(Component *component) = 0;
+
+        /// Number of live components in the pool
+        virtual unsigned int getCount() = 0;
+
+        /// The scene the pool belongs to
+        Scene *getScene(){return mScene;}
+
+    protected:
+        /// Calls T::update on a component the pool knows is a T, with the time to update it by
+        typedef bool (*UpdateFunction)(Component *component, float time);
+
+        /// Updates the component if the Scene's UpdateScheduler says it's due. Returns false if it wants to die
+        bool updateComponent(Component *component, UpdateFunction update);
+
+        /// Updates the parallel safe components in the slots [begin, end)
+        virtual void updateParallel(unsigned int begin, unsigned int end) = 0;
+
+        /// Runs updateParallel on a worker with the pool's scene bound, since workers may be helping out with some
+        /// other scene. data is the pool
+        static void updateParallelJob(void *data, unsigned int begin, unsigned int end);
+
+        /// Size and alignment the SceneManager recorded for the type with the given ComponentType ID, so its pool's
+        /// slots are laid out the way it was registered. The given size or alignment if the type wasn't registered
+        /// with them
+        static unsigned int getRegisteredSize(unsigned int typeID, unsigned int size);
+        static unsigned int getRegisteredAlignment(unsigned int typeID, unsigned int alignment);
+
+        Scene *mScene;
+
+    private:
+};
+
+template <typename T> class ComponentPool : public ComponentPoolBase
+{
+    public:
+        ComponentPool(Scene *scene) : ComponentPoolBase(scene),
+            mSlab(getRegisteredSize(ComponentType::getID<T>(), sizeof(T)),
+                  getRegisteredAlignment(ComponentType::getID<T>(), alignof(T))){}
+        virtual ~ComponentPool(){}
+
+        /// The PoolFactory for T
+        static ComponentPoolBase *make(Scene *scene){return new ComponentPool<T>(scene);}
+
+        /// Constructs a T in the pool. The arguments after the GameObject are passed to T's constructor
+        template <typename... Args> T *create(GameObject *object, Args&&... args)
+        {
+            unsigned int slot = mSlab.create(object, std::forward<Args>(args)...);
+
+            T *component = mSlab.get(slot);
+            component->setPool(this, slot);
+
+            return component;
+        }
+
+        virtual void updateAll(float dt)
+        {
+            // Spread the parallel safe components across the cores first
+            // Components get the time their GameObject was scheduled with rather than dt
+            if (JobSystem::get())
+                JobSystem::get()->parallelFor(mSlab.getSlotCount(), Slab<T>::ChunkSize, updateParallelJob, this);
+            else
+                updateParallelJob(this, 0, mSlab.getSlotCount());
+
+            for (unsigned int s = 0; s < mSlab.getSlotCount(); s++)
+            {
+                if (!mSlab.getUsed(s))
+                    continue;
+
+                T *component = mSlab.get(s);
+                if (component->getParallelSafe() || !isUpdateDue(component)) // Dead and resting objects aren't updated
+                    continue;
+
+                if (!updateComponent(component, update))
+                    component->getGameObject()->removeComponent(component);
+            }
+
+            // Components can only be removed by the thread updating the scene
+            for (unsigned int c = 0; c < mDeadComponents.size(); c++)
+                mDeadComponents[c]->getGameObject()->removeComponent(mDeadComponents[c]);
+            mDeadComponents.clear();
+        }
+
+        virtual void free(Component *component){mSlab.free(component->getPoolSlot());}
+
+        virtual unsigned int getCount(){return mSlab.getCount();}
+
+    protected:
+        /// Whether or not the Scene scheduled the component's GameObject to update this tick
+        static bool isUpdateDue(T *component)
+        {
+            return component->getGameObject()->getAlive() && component->getGameObject()->getUpdateDue();
+        }
+
+        /// The pool knows the exact type, so this isn't a virtual call
+        static bool update(Component *component, float time){return static_cast <T*> (component)->T::update(time);}
+
+        virtual void updateParallel(unsigned int begin, unsigned int end)
+        {
+            for (unsigned int s = begin; s < end; s++)
+            {
+                if (!mSlab.getUsed(s))
+                    continue;
+
+                T *component = mSlab.get(s);
+                if (!component->getParallelSafe() || !isUpdateDue(component))
+                    continue;
+
+                if (!updateComponent(component, update))
+                {
+                    sf::Lock lock(mDeadMutex);
+                    mDeadComponents.push_back(component);
+                }
+            }
+        }
+
+        /// Contiguous storage for the components
+        Slab<T> mSlab;
+
+        /// Parallel safe components that asked to die during the parallel update
+        std::vector <T*> mDeadComponents;
+        sf::Mutex mDeadMutex;
+
+    private:
+};
+
+#endif // COMPONENTPOOL_H
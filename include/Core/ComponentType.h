@@ -0,0 +1,48 @@
+/*
+ComponentType.h
+Theodore DeRego
+Copyright 2012
+
+Hands out a small integer ID for every Component type, so components can be indexed by type without RTTI
+*/
+
+#ifndef COMPONENTTYPE_H
+#define COMPONENTTYPE_H
+
+#include <atomic>
+
+class Component;
+
+class ComponentType
+{
+    public:
+        /// The most Component types there can be
+        static const unsigned int MaxTypes = 512;
+
+        /// Returns the ID of the Component type T. IDs are dense and start at 0, so they can be used as array indices
+        template <typename T> static unsigned int getID()
+        {
+            static unsigned int ID = registerType(&isA<T>);
+            return ID;
+        }
+
+        /// Number of Component types that have been given an ID so far
+        static unsigned int getTypeCount(){return TypeCount;}
+
+        /// Whether component is of the type with the given ID, or inherits from it
+        static bool isType(Component *component, unsigned int typeID){return Matchers[typeID](component);}
+
+    private:
+        typedef bool (*Matcher)(Component *component);
+
+        template <typename T> static bool isA(Component *component){return dynamic_cast <T*> (component) != NULL;}
+
+        /// Gives the type the next ID. Types can be seen for the first time on any thread
+        static unsigned int registerType(Matcher matcher);
+
+        /// Indexed by type ID. Each is set before TypeCount counts it
+        static Matcher Matchers[MaxTypes];
+        static std::atomic <unsigned int> TypeCount;
+};
+
+#endif // COMPONENTTYPE_H
@@ -0,0 +1,106 @@
+/*
+FramePacer.h
+Theodore DeRego
+Copyright 2012
+
+Decides when the game loop runs and what each frame does. Simulation ticks run at a fixed rate off an accumulator,
+while networking and rendering get their own target rates. Between frames the pacer sleeps until the next thing is
+due and only spins for a short tail, so an idle server doesn't burn a whole core.
+*/
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+class FramePacer
+{
+    public:
+        FramePacer();
+        virtual ~FramePacer();
+
+        /// Sleeps until something is due, then works out what this frame has to do
+        void beginFrame();
+
+        /// Forgets the time that has passed, so the next frame doesn't try to catch up on it. Call this after loading
+        void reset();
+
+        /// Nanoseconds on a clock that never goes backwards
+        static long long getTime();
+
+        // Accessors
+        unsigned int getTickCount(){return mTickCount;}
+        float getTickLength(){return mTickInterval/1000000000.f;}
+
+        /// How far into the next tick the frame is, from 0 to 1. For interpolating between the last two ticks
+        float getTickRatio(){return (float)mAccumulator/mTickInterval;}
+
+        bool getNetworkDue(){return mNetworkDue;}
+        bool getRenderDue(){return mRenderDue;}
+
+        /// Seconds since the last frame and since the last frame that updated the network
+        float getFrameTime(){return mFrameTime/1000000000.f;}
+        float getNetworkTime(){return mNetworkTime/1000000000.f;}
+
+        /// Ticks thrown away because the simulation fell too far behind
+        unsigned int getDroppedTicks(){return mDroppedTicks;}
+
+        // Mutators
+        void setTickRate(float rate){mTickInterval=toInterval(rate);}
+
+        /// 0 updates the network or renders every frame
+        void setNetworkRate(float rate){mNetworkInterval=toInterval(rate);}
+        void setRenderRate(float rate){mRenderInterval=toInterval(rate);}
+
+        /// Whether frames render at all. Without rendering, only ticks and the network wake the loop up
+        void setRendering(bool rendering){mRendering=rendering;}
+
+        /// Most frames per second when networking or rendering runs every frame
+        void setMaxFrameRate(float rate){mMinFrameInterval=toInterval(rate);}
+
+        /// Most ticks one frame runs to catch up. Time past that is dropped instead of making the next frame longer
+        void setMaxTicksPerFrame(unsigned int ticks){mMaxTicksPerFrame=ticks;}
+
+        /// Seconds before a deadline to stop sleeping and start spinning, to cover how late the OS wakes us
+        void setSpinTime(float seconds){mSpinTime=seconds*1000000000.f;}
+
+    protected:
+        /// Nanoseconds between events at rate per second. 0 for a rate of 0
+        static long long toInterval(float rate){return rate > 0 ? (long long)(1000000000.0/rate) : 0;}
+
+        /// When the next frame should start
+        long long getNextFrameTime();
+
+        /// Sleeps until most of the way to time, then spins the rest
+        void sleepUntil(long long time);
+
+        long long mTickInterval;
+        long long mNetworkInterval;
+        long long mRenderInterval;
+        bool mRendering;
+        long long mMinFrameInterval;
+        unsigned int mMaxTicksPerFrame;
+        long long mSpinTime;
+
+        /// When the last frame started. Negative before the first frame
+        long long mLastFrame;
+
+        /// Time that hasn't been simulated yet
+        long long mAccumulator;
+
+        /// When the network and rendering are next due
+        long long mNextNetwork;
+        long long mNextRender;
+        long long mLastNetwork;
+
+        // What the current frame has to do
+        unsigned int mTickCount;
+        bool mNetworkDue;
+        bool mRenderDue;
+        long long mFrameTime;
+        long long mNetworkTime;
+
+        unsigned int mDroppedTicks;
+
+    private:
+};
+
+#endif // FRAMEPACER_H
@@ -11,13 +11,33 @@ Also, components can be attached for functionality.
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
+#include <atomic>
 #include <vector>
+#include <string>
+#include <unordered_map>
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Transform.hpp>
 #include <SFML/Network/Packet.hpp>
 
 #include "Core/RefCounted.h"
+#include "Core/Handle.h"
 #include "Core/Component.h"
+#include "Core/ComponentType.h"
+#include "Core/ComponentPool.h"
+
+class Scene;
+
+/// How often the Scene updates an object
+namespace ActivityTier
+{
+    enum
+    {
+        ACTIVE, // Every tick
+        IDLE, // Every few ticks, with the time in between added up
+        DORMANT // Not at all until something wakes it
+    };
+};
 
 class GameObject : public RefCounted
 {
@@ -25,10 +45,23 @@ class GameObject : public RefCounted
         GameObject();
         virtual ~GameObject();
 
+        /// Allocates a GameObject from the shared slab. Use this rather than new when spawning lots of objects
+        static GameObject *create();
+
+        /// Looks up a GameObject by handle. Returns NULL if the object has been destroyed
+        static GameObject *get(Handle handle){return Handles.get(handle);}
+
         void serialize(sf::Packet &packet);
         void deserialize(sf::Packet &packet);
 
+        /// Reads what serialize wrote after the ID
+        void deserializeComponents(sf::Packet &packet);
+
+        /// Updates the components that aren't parallel safe. updateParallel is called first in the same tick
         virtual bool update(float dt);
+
+        /// Updates the parallel safe components. The Scene may call this from a worker thread
+        void updateParallel(float dt);
         virtual void onRender(sf::RenderTarget *target, sf::RenderStates states = sf::RenderStates::Default);
 
         /// Called before a collision is processed
@@ -40,64 +73,261 @@ class GameObject : public RefCounted
         /// Called when this object stops colliding with another GameObject
         virtual void onContactEnd(GameObject *object);
 
+        /// Called by the Scene at the end of the tick this object dies in, before it is released
+        virtual void onDestroy();
+
+        /// Called on clients when the object comes into or goes out of the area the server keeps them up to date on
+        virtual void onNetworkEnter();
+        virtual void onNetworkLeave();
+
         Component *addComponent(Component *component);
+
+        /// Creates a T in its ComponentPool and attaches it. Pooled components are updated by the Scene, not by update().
+        /// The object has to be in a scene first, since that's where the pools are
+        template <typename T, typename... Args> T *addPooledComponent(Args&&... args)
+        {
+            T *component = createPooledComponent<T>(std::forward<Args>(args)...);
+            addComponent(component);
+            return component;
+        }
+
+        /// Creates a T in its ComponentPool without attaching it, for creation functions
+        template <typename T, typename... Args> T *createPooledComponent(Args&&... args)
+        {
+            ComponentPool<T> *pool = static_cast <ComponentPool<T>*> (getPool(ComponentType::getID<T>(), &ComponentPool<T>::make));
+            return pool->create(this, std::forward<Args>(args)...);
+        }
         void removeComponent(Component *component);
 
-        /// Getting components by type
-        template <typename T> T *getComponent(std::string name = "")
+        /// Getting components by type, and by name too if one is given. Only reads the indices, so other threads can
+        /// look up components on this object while it isn't changing its components
+        template <typename T> T *getComponent(Symbol name = Symbol())
         {
+            unsigned int typeID = ComponentType::getID<T>();
+
+            Component *first;
+            TypeIndex *index = mTypeIndex.load(std::memory_order_acquire);
+            if (index && typeID < index->size())
+                first = (*index)[typeID];
+            else // A type seen for the first time since the index was built
+                first = indexNewType(typeID);
+
+            if (name.empty()) //no name specified
+                return static_cast <T*> (first);
+
+            std::unordered_map <Symbol, Component*, Symbol::Hash>::iterator named = mNameIndex.find(name);
+            if (named == mNameIndex.end())
+                return NULL;
+            if (named->second == first) //the named component is the first of its type - no need to check
+                return static_cast <T*> (first);
+            if (T *component = dynamic_cast <T*> (named->second))
+                return component;
+
+            // The first component with the name is another type. Names should be unique, but the first one that is
+            // a T is the one asked for
             for (unsigned int c = 0; c < mComponents.size(); c++)
             {
-                if (name == "" || mComponents[c]->getName() == name) //no name specified or matching name
+                if (mComponents[c]->getName() == name)
                 {
-                    if (dynamic_cast <T*> (mComponents[c])) //exact match or inherited from
-                        return (T*)mComponents[c];
+                    if (T *component = dynamic_cast <T*> (mComponents[c]))
+                        return component;
                 }
             }
-            return 0;
+
+            return NULL;
         }
 
-        void kill(){mAlive=false;}
+        /// Looks up by a plain string without interning it on every call
+        template <typename T> T *getComponent(const char *name){return getComponent<T>(Symbol::fromID(Symbol::hash(name)));}
+
+        /// Rebuilds the name index and subscriber lists and forgets cached type lookups. Called when a component is
+        /// renamed
+        void rebuildComponentIndex();
+
+        /// Kills this object and all of its children
+        void kill();
+
+        /// Makes the object active again on the next tick, whatever its tier
+        void wake(){mWakeRequested=true;}
+
+        /// Attaches a child. The child's position and rotation become relative to this object. A child with a
+        /// simulated body shouldn't be attached, since the body sets the child's position in world space
+        void addChild(GameObject *child);
+        void removeChild(GameObject *child);
+
+        /// Local to world transform, in world units. Cached until this object or one of its parents moves. Building
+        /// it writes the cache of this object and its parents, so the Scene builds every out of date one before
+        /// each parallel update. Parallel safe components mustn't move objects that have children
+        const sf::Transform &getWorldTransform();
+        sf::Vector2f getWorldPosition(){return getWorldTransform().transformPoint(0, 0);}
+        float getWorldRotation(){getWorldTransform(); return mWorldRotation;}
+
+        /// World position, rotation and transform to draw the object at. alpha is how far the frame is between the
+        /// last tick and the one before it, from 0 to 1, and blends between where the object was after each
+        sf::Vector2f getRenderPosition(float alpha);
+        float getRenderRotation(float alpha);
+        sf::Transform getRenderTransform(float alpha);
+
+        /// Called by the Scene at the start of each tick to remember where the object was before the tick moves it
+        void storePreviousTransform();
+
+        /// Draws the object exactly where it is until the next tick, instead of blending from where it was. Call
+        /// this after teleporting an object
+        void resetInterpolation(){mHasPreviousTransform=false;}
 
         // Accessors
+        Handle getHandle(){return mHandle;}
         int getID(){return mID;}
+        bool getAllocatedID(){return mAllocatedID;}
+        Scene *getScene(){return mScene;}
+        std::vector <Component*> &getComponents(){return mComponents;}
         bool getAlive(){return mAlive;}
         bool getSyncNetwork(){return mSyncNetwork;}
+        int getActivityTier(){return mActivityTier;}
+        bool getAlwaysActive(){return mAlwaysActive;}
+        bool getActivityAnchor(){return mActivityAnchor;}
+        bool getWakeRequested(){return mWakeRequested;}
+
+        /// Whether or not the object updates this tick, and the time to pass to update if it does. Set by the Scene
+        bool getUpdateDue(){return mUpdateDue;}
+        float getUpdateTime(){return mUpdateTime;}
+        GameObject *getParent(){return mParent;}
+        std::vector <GameObject*> &getChildren(){return mChildren;}
+
+        /// Position and rotation relative to the parent. The same as the world ones for objects without a parent
         sf::Vector2f getPosition(){return mPosition;}
         float getRotation(){return mRotation;}
 
         // Mutators
-        void setID(int ID){mID=ID;}
+        /// Changes the ID and keeps the Scene's ID index up to date. allocated says the ID came from the Scene's
+        /// IDAllocator, which takes it back when the object goes. IDs the server handed out aren't the allocator's
+        void setID(int ID, bool allocated = false);
+        void setScene(Scene *scene){mScene=scene;}
         void setSyncNetwork(bool sync){mSyncNetwork=sync;}
+        /// Always active objects are updated every tick no matter where they are. For objects that move themselves
+        void setAlwaysActive(bool active){mAlwaysActive=active;}
+        /// Anchors keep the objects around them active, like the camera does. Players are anchors
+        void setActivityAnchor(bool anchor){mActivityAnchor=anchor;}
+
+        /// Called by the Scene once a tick to say whether the object updates and with how much time
+        void scheduleUpdate(int tier, float dt, unsigned int idleInterval);
         void setPosition(sf::Vector2f position, Component *caller = NULL);
         void setRotation(float rotation, Component *caller = NULL);
 
     protected:
+        /// Returns slab allocated objects to the slab instead of deleting them
+        virtual void destroy();
+
         /// Generic type for users to give this object
         int mType;
 
-        /// Object's ID - primarily used in networking
+        /// Object's ID - primarily used in networking. -1 until the authority gives it one
         int mID;
 
+        /// Whether or not mID came from the Scene's IDAllocator rather than the server
+        bool mAllocatedID;
+
+        /// The Scene this object was added to
+        Scene *mScene;
+
         /// Whether or not the object should live to see another frame
         bool mAlive;
 
         /// Whether or not to sync over the network
         bool mSyncNetwork;
 
-        /// Object's world position
+        /// ActivityTier the Scene last put this object in
+        int mActivityTier;
+
+        bool mAlwaysActive;
+        bool mActivityAnchor;
+        bool mWakeRequested;
+
+        /// This tick's update schedule
+        bool mUpdateDue;
+        float mUpdateTime;
+
+        /// Time that passed while the object was idle and not updated
+        float mSkippedTime;
+        unsigned int mSkippedTicks;
+
+        /// Object's position relative to its parent
         sf::Vector2f mPosition;
 
-        /// Object rotation
+        /// Object rotation relative to its parent
         float mRotation;
 
+        /// Marks the cached world transform of this object and its children out of date
+        void setWorldDirty();
+
+        GameObject *mParent;
+        std::vector <GameObject*> mChildren;
+
+        /// Cached local to world transform and rotation
+        sf::Transform mWorldTransform;
+        float mWorldRotation;
+
+        /// Whether or not the cached world transform needs rebuilding. When an object is dirty, so are its children
+        bool mWorldDirty;
+
+        /// World position and rotation at the start of the current tick, for render interpolation
+        sf::Vector2f mPreviousWorldPosition;
+        float mPreviousWorldRotation;
+        bool mHasPreviousTransform;
+
         /// The array of components attached to this object
         std::vector <Component*> mComponents;
 
+        /// Components that asked to die this tick. They are removed at the end of update()
+        std::vector <Component*> mDeadComponents;
+
+        /// First component of each type, or NULL, indexed by ComponentType ID. NULL until the first component is
+        /// added. Entries are kept up to date as components are added, so lookups never write to it
+        typedef std::vector <Component*> TypeIndex;
+        std::atomic <TypeIndex*> mTypeIndex;
+
+        /// Indices that were replaced by a bigger one while other threads may still have been reading them. Freed
+        /// the next time the components change, since nothing can be looking them up then
+        std::vector <TypeIndex*> mRetiredTypeIndices;
+
+        /// Fills in the type index for a component that was just added, and for any types seen for the first time
+        /// since it was last updated. added can be NULL
+        void indexComponentTypes(Component *added);
+
+        /// Looks up a type that got its ID after the index was built. Publishes a copy of the index that covers it, so
+        /// the type is only scanned for once and lookups on other threads can carry on with the old one
+        Component *indexNewType(unsigned int typeID);
+
+        /// Adds the types in [begin, end) to index, checking every component
+        void fillTypeIndex(TypeIndex *index, unsigned int begin, unsigned int end);
+
+        /// Components by name
+        std::unordered_map <Symbol, Component*, Symbol::Hash> mNameIndex;
+
+        /// Components subscribed to each ComponentCallback
+        std::vector <Component*> mSubscribers[ComponentCallback::COUNT];
+
+        /// Adds the component to the subscriber lists of its callbacks
+        void subscribeComponent(Component *component);
+
+        /// Updates the component if the Scene's UpdateScheduler says it's due. Returns false if it wants to die
+        bool updateComponent(Component *component, float dt);
+
+        /// The pool for a component type in the scene this object was added to. See Scene::getPool
+        ComponentPoolBase *getPool(unsigned int typeID, PoolFactory factory);
+
         /// This is the render target for all components
         sf::Texture *mRenderTarget;
 
+        /// Handle to this object that is safe to hold after it is destroyed
+        Handle mHandle;
+
+        /// Whether or not this object came from the slab, and where
+        bool mSlabAllocated;
+        unsigned int mSlabSlot;
+
     private:
+        static HandleTable <GameObject> Handles;
 };
 
 #endif // GAMEOBJECT_H
@@ -0,0 +1,144 @@
+/*
+Handle.h
+Theodore DeRego
+Copyright 2012
+
+Generational handles to objects. A handle is an index plus the generation of the slot it was given out for,
+so looking up a handle to a destroyed object fails instead of returning a dangling pointer.
+*/
+
+#ifndef HANDLE_H
+#define HANDLE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Mutex.hpp>
+
+struct Handle
+{
+    Handle(){mIndex=0;mGeneration=0;}
+    Handle(unsigned int index, unsigned int generation){mIndex=index;mGeneration=generation;}
+
+    bool operator==(const Handle &other) const {return mIndex==other.mIndex&&mGeneration==other.mGeneration;}
+    bool operator!=(const Handle &other) const {return !(*this==other);}
+
+    unsigned int mIndex;
+
+    /// Generation 0 is never handed out, so a default constructed handle is always invalid
+    unsigned int mGeneration;
+};
+
+/// Handles can be added and removed from any thread. Looking one up doesn't lock, since slots never move, but an object
+/// should only be looked up from the thread that's allowed to destroy it
+template <typename T> class HandleTable
+{
+    public:
+        /// Number of slots in each chunk, and the most chunks there can be
+        static const unsigned int ChunkSize = 4096;
+        static const unsigned int MaxChunks = 4096;
+
+        HandleTable()
+        {
+            for (unsigned int c = 0; c < MaxChunks; c++)
+                mChunks[c] = NULL;
+            mSlotCount = 0;
+        }
+
+        ~HandleTable()
+        {
+            for (unsigned int c = 0; c < MaxChunks; c++)
+                delete[] mChunks[c];
+        }
+
+        /// Gives the object a slot and returns a handle to it. Running out of slots is fatal, since nothing made
+        /// without a handle could ever be looked up or destroyed through one
+        Handle add(T *object)
+        {
+            sf::Lock lock(mMutex);
+
+            unsigned int index;
+            if (mFreeIndices.size() > 0)
+            {
+                index = mFreeIndices.back();
+                mFreeIndices.pop_back();
+            }
+            else
+            {
+                index = mSlotCount.load(std::memory_order_relaxed);
+                if (index >= ChunkSize*MaxChunks)
+                {
+                    std::cout << "Out of handles. Raise HandleTable::MaxChunks\n";
+                    std::abort();
+                }
+
+                if (index%ChunkSize == 0)
+                    mChunks[index/ChunkSize] = new Slot[ChunkSize];
+
+                // Publish the slot only once its chunk exists
+                mSlotCount.store(index+1, std::memory_order_release);
+            }
+
+            Slot &slot = getSlot(index);
+            slot.mObject = object;
+            return Handle(index, slot.mGeneration);
+        }
+
+        /// Frees the handle's slot. Every outstanding copy of the handle becomes stale
+        void remove(Handle handle)
+        {
+            sf::Lock lock(mMutex);
+
+            if (!isValid(handle))
+                return;
+
+            Slot &slot = getSlot(handle.mIndex);
+            slot.mObject = NULL;
+            slot.mGeneration++;
+            if (slot.mGeneration == 0) // Skip the null generation when it wraps
+                slot.mGeneration = 1;
+
+            mFreeIndices.push_back(handle.mIndex);
+        }
+
+        bool isValid(Handle handle)
+        {
+            if (handle.mIndex >= mSlotCount.load(std::memory_order_acquire))
+                return false;
+
+            Slot &slot = getSlot(handle.mIndex);
+            return slot.mGeneration == handle.mGeneration && slot.mObject;
+        }
+
+        /// Returns the object or NULL if the handle is stale
+        T *get(Handle handle){return isValid(handle)?getSlot(handle.mIndex).mObject:NULL;}
+
+    protected:
+        struct Slot
+        {
+            Slot(){mObject=NULL;mGeneration=1;}
+
+            T *mObject;
+            unsigned int mGeneration;
+        };
+
+        Slot &getSlot(unsigned int index){return mChunks[index/ChunkSize][index%ChunkSize];}
+
+        /// Fixed size blocks of slots. Blocks never move, so other threads can look slots up while more are added
+        Slot *mChunks[MaxChunks];
+        std::atomic <unsigned int> mSlotCount;
+
+        /// Slots that can be handed out again
+        std::vector <unsigned int> mFreeIndices;
+
+        /// Guards adding and removing
+        sf::Mutex mMutex;
+
+    private:
+};
+
+#endif // HANDLE_H
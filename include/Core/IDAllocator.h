@@ -0,0 +1,57 @@
+/*
+IDAllocator.h
+Theodore DeRego
+Copyright 2012
+
+Hands out GameObject IDs on the authority. The low bits of an ID are an index that gets recycled and the high bits
+are the index's generation, so a reused index never produces an ID that was already handed out recently.
+*/
+
+#ifndef IDALLOCATOR_H
+#define IDALLOCATOR_H
+
+#include <deque>
+#include <vector>
+
+class IDAllocator
+{
+    public:
+        /// Bits of an ID used for the index. The generation gets the rest, minus the sign bit
+        static const unsigned int IndexBits = 20;
+        static const unsigned int IndexMask = (1u << IndexBits)-1;
+        static const unsigned int GenerationMask = (1u << (31-IndexBits))-1;
+
+        /// Freed indices wait until there are this many before any is reused. The generation only has 11 bits, so
+        /// an index reused straight away, like a projectile's, would wrap after 2047 reuses and stale IDs would
+        /// find the wrong object. Held back like this, that takes millions of allocations
+        static const unsigned int MinFreeIndices = 1024;
+
+        IDAllocator();
+        virtual ~IDAllocator();
+
+        /// Returns an unused ID. IDs are never 0. Returns -1, no ID, if every index is in use
+        int allocate();
+
+        /// Returns the ID's index to the allocator. Freeing an ID that isn't current does nothing
+        void free(int ID);
+
+        /// Whether or not the ID was handed out and hasn't been freed since
+        bool isCurrent(int ID);
+
+        static unsigned int getIndex(int ID){return (unsigned int)ID & IndexMask;}
+        static unsigned int getGeneration(int ID){return ((unsigned int)ID >> IndexBits) & GenerationMask;}
+
+    protected:
+        /// The generation each index is currently on
+        std::vector <unsigned int> mGenerations;
+
+        /// Whether or not each index is handed out
+        std::vector <bool> mUsed;
+
+        /// Indices that can be handed out again, oldest first
+        std::deque <unsigned int> mFreeIndices;
+
+    private:
+};
+
+#endif // IDALLOCATOR_H
@@ -29,6 +29,7 @@ class InputManager : public Manager
         };
 
     public:
+        /// window can be NULL for a headless game, which never gets any input
         InputManager(sf::Window *window);
         virtual ~InputManager();
 
@@ -42,6 +43,10 @@ class InputManager : public Manager
         bool getKeyDown(int key){return mKeyStates[key]==ButtonState::DOWN||mKeyStates[key]==ButtonState::PRESSED;}
         bool getKeyUp(int key){return mKeyStates[key]==ButtonState::UP||mKeyStates[key]==ButtonState::RELEASED;}
 
+        /// How many times the key has been pressed since the game started. For checking a key less often than every
+        /// tick without missing presses or seeing the same one twice
+        unsigned int getKeyPressCount(int key){return mKeyPressCounts[key];}
+
         // Mouse
         int getLMBState(){return mMouseState.mLMBState;}
         bool getLMBDown(){return mMouseState.mLMBState==ButtonState::DOWN||mMouseState.mLMBState==ButtonState::PRESSED;}
@@ -69,6 +74,7 @@ class InputManager : public Manager
 
         /// Keyboard key states
         int mKeyStates[sf::Keyboard::KeyCount];
+        unsigned int mKeyPressCounts[sf::Keyboard::KeyCount];
 
         /// Mouse state
         MouseState mMouseState;
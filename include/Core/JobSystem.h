@@ -0,0 +1,126 @@
+/*
+JobSystem.h
+Theodore DeRego
+Copyright 2012
+
+A pool of worker threads that split loops between them. Every thread has its own job queue, and threads that run
+out of work steal jobs from the others. Threads with nothing to do sleep until jobs are dispatched, so an idle pool
+costs no CPU.
+*/
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include <SFML/System/Mutex.hpp>
+#include <SFML/System/Thread.hpp>
+
+#include "Core/Semaphore.h"
+
+/// Processes the items [begin, end) of a loop
+typedef void (*JobFunction)(void *data, unsigned int begin, unsigned int end);
+
+class JobSystem
+{
+    public:
+        /// Starts workerCount worker threads. 0 means one less than the number of hardware threads
+        JobSystem(unsigned int workerCount = 0);
+        virtual ~JobSystem();
+
+        /// Runs function over [0, count) in batches of batchSize spread across the workers.
+        /// The calling thread helps out and this returns once every batch is done. Jobs can call this too, since
+        /// waiting threads run any other jobs there are before they sleep
+        void parallelFor(unsigned int count, unsigned int batchSize, JobFunction function, void *data);
+
+        /// Like parallelFor, but returns straight away so the calling thread can do something else meanwhile.
+        /// remaining counts the batches left and has to stay alive until wait() on it returns
+        void dispatch(unsigned int count, unsigned int batchSize, JobFunction function, void *data,
+                      std::atomic <unsigned int> *remaining);
+
+        /// Helps out until every batch counted by remaining is done, and sleeps while there's nothing to help with
+        void wait(std::atomic <unsigned int> *remaining);
+
+        // Accessors
+        unsigned int getWorkerCount(){return mWorkers.size();}
+
+        static JobSystem *get(){return Instance;}
+
+    protected:
+        struct Job
+        {
+            JobFunction mFunction;
+            void *mData;
+            unsigned int mBegin;
+            unsigned int mEnd;
+
+            /// Batches of this job's loop that haven't finished yet
+            std::atomic <unsigned int> *mRemaining;
+        };
+
+        /// One of these per thread. Queue 0 belongs to the main thread, and any other thread that isn't a worker
+        /// shares it. Only one thread at a time may wait on queue 0
+        struct JobQueue
+        {
+            sf::Mutex mMutex;
+            std::deque <Job> mJobs;
+
+            /// The queue's thread sleeps on this while it has nothing to do
+            Semaphore mWake;
+        };
+
+        struct Worker
+        {
+            JobSystem *mJobSystem;
+            unsigned int mQueue;
+            sf::Thread *mThread;
+        };
+
+        static void workerMain(Worker *worker);
+
+        /// Takes the newest job from a thread's own queue
+        bool popJob(unsigned int queue, Job &job);
+
+        /// Takes the oldest job from some other thread's queue
+        bool stealJob(unsigned int queue, Job &job);
+
+        void runJob(Job &job);
+
+        /// Puts the calling thread to sleep until it's woken, as long as no jobs are queued. A waiting thread passes
+        /// the batches it's waiting on and only sleeps while some are left. A worker passes NULL and only sleeps
+        /// while the JobSystem is running
+        void sleep(std::atomic <unsigned int> *remaining);
+
+        /// Wakes every sleeping thread so they check whether there's anything for them now
+        void wakeSleepers();
+
+        bool getRunning();
+
+        std::vector <JobQueue*> mQueues;
+        std::vector <Worker*> mWorkers;
+
+        /// Jobs sitting in the queues. Threads only go to sleep while it's 0
+        std::atomic <unsigned int> mQueuedJobs;
+
+        /// Queues whose threads are asleep, or about to be. Each thread has its own semaphore so a wakeup can't go to
+        /// the wrong one. They're woken when jobs are dispatched, when the last batch of a loop finishes and when
+        /// the workers are shut down
+        std::vector <unsigned int> mSleepers;
+
+        /// Guards mSleepers and mRunning. A thread checks there's nothing to do and joins mSleepers under it, so it
+        /// can't miss a wakeup in between
+        sf::Mutex mWakeMutex;
+
+        /// Set to false to shut the workers down
+        bool mRunning;
+
+    private:
+        static JobSystem *Instance;
+
+        /// The queue of the calling thread. 0 on the main thread and on any thread that isn't a worker
+        static thread_local unsigned int CurrentQueue;
+};
+
+#endif // JOBSYSTEM_H
@@ -1,5 +1,5 @@
 /*
-RefCounted.h
+Manager.h
 Theodore DeRego
 Copyright 2012
 
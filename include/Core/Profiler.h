@@ -0,0 +1,128 @@
+/*
+Profiler.h
+Theodore DeRego
+Copyright 2012
+
+Measures the time and number of calls each component type takes in update, onRender and the contact callbacks.
+Totals are gathered per frame and the last HistoryLength frames are kept so they can be dumped to CSV or JSON.
+The PROFILE_ macros only do anything when FISSION_PROFILE is defined, so release builds pay nothing for them.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include <SFML/System/Mutex.hpp>
+
+#include "Core/Symbol.h"
+
+class Component;
+
+namespace ProfileEvent
+{
+    enum
+    {
+        UPDATE,
+        RENDER,
+        CONTACT, // onPreSolve, onContactBegin and onContactEnd
+
+        COUNT
+    };
+}
+
+class Profiler
+{
+    public:
+        /// Number of frames kept for each component type
+        static const unsigned int HistoryLength = 128;
+
+        Profiler();
+        virtual ~Profiler();
+
+        /// Adds one call to the current frame's totals. Thread safe
+        void addSample(Symbol typeName, unsigned int event, float milliseconds);
+
+        /// Moves the current frame's totals into the history. Call this once at the end of every frame
+        void endFrame();
+
+        /// Writes the mean calls per frame and the mean, median, 95th percentile and worst time per frame of every
+        /// type and event. Returns false if the file couldn't be opened
+        bool dumpCSV(const std::string &fileName);
+
+        /// Writes the same stats as dumpCSV plus the time of every frame in the history
+        bool dumpJSON(const std::string &fileName);
+
+        /// Forgets everything recorded so far
+        void clear();
+
+        static Profiler *get();
+
+        /// Times one callback of a component and adds it to the profiler when it goes out of scope
+        class Sample
+        {
+            public:
+                Sample(Component *component, unsigned int event);
+                ~Sample();
+
+            private:
+                Symbol mTypeName;
+                unsigned int mEvent;
+
+                /// sf::Clock only counts microseconds, which is longer than most component updates take
+                std::chrono::high_resolution_clock::time_point mStart;
+        };
+
+    protected:
+        /// Time and calls of one type and event over one frame
+        struct Frame
+        {
+            float mTime;
+            unsigned int mCalls;
+        };
+
+        struct TypeHistory
+        {
+            Frame mCurrent[ProfileEvent::COUNT];
+
+            /// Ring buffer of finished frames, indexed by frame number modulo HistoryLength
+            Frame mFrames[ProfileEvent::COUNT][HistoryLength];
+        };
+
+        /// Summary of the history of one type and event
+        struct Stats
+        {
+            float mCalls;
+            float mMean;
+            float mMedian;
+            float mPercentile95;
+            float mWorst;
+        };
+
+        Stats getStats(TypeHistory &history, unsigned int event);
+
+        /// Number of finished frames in the history
+        unsigned int getFrameCount(){return mFrame < HistoryLength ? mFrame : HistoryLength;}
+
+        std::unordered_map <Symbol, TypeHistory, Symbol::Hash> mTypes;
+
+        /// Frames finished since the profiler was created or cleared
+        unsigned int mFrame;
+
+        /// Guards everything, since pooled components report from the worker threads
+        sf::Mutex mMutex;
+
+    private:
+};
+
+#ifdef FISSION_PROFILE
+    #define PROFILE_COMPONENT(component, event) Profiler::Sample profileSample(component, event)
+    #define PROFILE_END_FRAME() Profiler::get()->endFrame()
+#else
+    #define PROFILE_COMPONENT(component, event)
+    #define PROFILE_END_FRAME()
+#endif
+
+#endif // PROFILER_H
@@ -20,10 +20,13 @@ class RefCounted
         {
             mRefs--;
             if (mRefs == 0)
-                delete this;
+                destroy();
         }
 
     protected:
+        /// Frees the object once nothing references it. Override for objects that weren't allocated with new
+        virtual void destroy(){delete this;}
+
     private:
         int mRefs;
 };
@@ -5,6 +5,7 @@
 #include <vector>
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/System/Mutex.hpp>
 
 #include <Core/Manager.h>
 
@@ -20,9 +21,19 @@ class ResourceManager : public Manager
         ResourceManager();
         virtual ~ResourceManager();
 
+        /// Always NULL when headless, since a texture needs a GL context
         sf::Texture *getTexture(std::string name);
+
+        /// Always NULL when built with FISSION_HEADLESS, which leaves out text rendering
         sf::Font *getFont(std::string name);
 
+        /// Size of an image in pixels. A headless game reads the size without making a texture, since things like
+        /// physics bodies are sized from their sprites
+        sf::Vector2u getImageSize(std::string name);
+
+        bool getHeadless(){return mHeadless;}
+        void setHeadless(bool headless){mHeadless=headless;}
+
         static ResourceManager *get(){return Instance;}
 
     protected:
@@ -31,6 +42,14 @@ class ResourceManager : public Manager
         //all of the resources
         std::vector <Resource> mResources;
 
+        /// Image sizes read while headless
+        std::vector <Resource> mImageSizes;
+
+        bool mHeadless;
+
+        /// Scenes on other threads load resources too
+        sf::Mutex mMutex;
+
     private:
         static ResourceManager *Instance;
 };
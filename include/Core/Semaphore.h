@@ -0,0 +1,35 @@
+/*
+Semaphore.h
+Theodore DeRego
+Copyright 2012
+
+A counting semaphore, for threads that need to sleep until another thread has something for them. SFML has no way
+to wait on a condition, so this wraps the platform's own semaphore the way sf::Mutex wraps the platform's mutex.
+*/
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <SFML/System/NonCopyable.hpp>
+
+class Semaphore : sf::NonCopyable
+{
+    public:
+        /// Starts with a count of 0, so the first wait blocks until something is posted
+        Semaphore();
+        virtual ~Semaphore();
+
+        /// Blocks until the count is above 0, then takes 1 from it
+        void wait();
+
+        /// Adds count, letting that many waits through
+        void post(unsigned int count = 1);
+
+    protected:
+        /// A HANDLE on Windows and a sem_t everywhere else. Kept opaque so the platform headers stay out of here
+        void *mSemaphore;
+
+    private:
+};
+
+#endif // SEMAPHORE_H
@@ -0,0 +1,109 @@
+/*
+Slab.h
+Theodore DeRego
+Copyright 2012
+
+Allocates objects of one type out of fixed size chunks, so spawning many objects only rarely hits the heap. Slots can
+be given more room or a stricter alignment than the type needs, such as a whole cache line each.
+*/
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+template <typename T> class Slab
+{
+    public:
+        /// Number of objects stored in each chunk
+        static const unsigned int ChunkSize = 256;
+
+        /// Each slot gets size bytes aligned to alignment, which must be a power of two. Slots are never smaller or
+        /// less aligned than T needs
+        Slab(unsigned int size = sizeof(T), unsigned int alignment = alignof(T))
+        {
+            mCount = 0;
+            mAlignment = alignment > alignof(T) ? alignment : alignof(T);
+            mStride = size > sizeof(T) ? size : sizeof(T);
+            mStride = (mStride+mAlignment-1)/mAlignment*mAlignment;
+        }
+        ~Slab()
+        {
+            // Slabs live for the whole program, so only the memory is returned here
+            for (unsigned int c = 0; c < mBlocks.size(); c++)
+                ::operator delete(mBlocks[c]);
+        }
+
+        /// Constructs a T in a free slot and returns the slot
+        template <typename... Args> unsigned int create(Args&&... args)
+        {
+            unsigned int slot;
+            if (mFreeSlots.size() > 0) // Reuse a slot so the slab stays dense
+            {
+                slot = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            }
+            else
+            {
+                slot = mUsed.size();
+                if (slot%ChunkSize == 0)
+                {
+                    // operator new only aligns for the built-in types, so ask for enough to line the chunk up
+                    char *block = static_cast <char*> (::operator new(mStride*ChunkSize+mAlignment-1));
+                    mBlocks.push_back(block);
+                    mChunks.push_back(block+(mAlignment-reinterpret_cast <std::size_t> (block)%mAlignment)%mAlignment);
+                }
+                mUsed.push_back(false);
+            }
+
+            new (get(slot)) T(std::forward<Args>(args)...);
+            mUsed[slot] = true;
+            mCount++;
+
+            return slot;
+        }
+
+        /// Destroys the object in a slot and makes the slot available again
+        void free(unsigned int slot)
+        {
+            get(slot)->~T();
+            mUsed[slot] = false;
+            mFreeSlots.push_back(slot);
+            mCount--;
+        }
+
+        // Accessors
+        T *get(unsigned int slot){return reinterpret_cast <T*> (mChunks[slot/ChunkSize]+(slot%ChunkSize)*mStride);}
+        bool getUsed(unsigned int slot){return mUsed[slot];}
+        unsigned int getSlotCount(){return mUsed.size();}
+        unsigned int getCount(){return mCount;}
+        unsigned int getStride(){return mStride;}
+        unsigned int getAlignment(){return mAlignment;}
+
+    protected:
+        /// Fixed size blocks of storage as they were allocated. Blocks never move, so object pointers stay valid
+        std::vector <char*> mBlocks;
+
+        /// Start of the first slot in each block
+        std::vector <char*> mChunks;
+
+        /// Bytes from one slot to the next, and what every slot is aligned to
+        unsigned int mStride;
+        unsigned int mAlignment;
+
+        /// Whether or not each slot holds a live object
+        std::vector <bool> mUsed;
+
+        /// Slots that have been freed and can be reused
+        std::vector <unsigned int> mFreeSlots;
+
+        /// Number of live objects
+        unsigned int mCount;
+
+    private:
+};
+
+#endif // SLAB_H
@@ -0,0 +1,60 @@
+/*
+Symbol.h
+Theodore DeRego
+Copyright 2012
+
+An interned string. A symbol is the 32 bit hash of its string, so symbols compare and hash as integers, and every
+copy of a name shares one string in the symbol table. The hash is the same in every process, so symbols can be sent
+over the network as their ID. Two different strings with the same hash are a fatal error, found the first time both
+are interned.
+*/
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstddef>
+#include <string>
+
+class Symbol
+{
+    public:
+        /// The empty symbol
+        Symbol(){mID=0;}
+        Symbol(const char *string);
+        Symbol(const std::string &string);
+
+        /// Makes a symbol from an ID that came from Symbol::getID, usually on another machine
+        static Symbol fromID(unsigned int ID){Symbol symbol; symbol.mID=ID; return symbol;}
+
+        /// The ID a string would get, without interning it. Enough for lookups, since nothing can be stored under a
+        /// symbol that was never interned
+        static unsigned int hash(const char *string);
+
+        bool operator==(const Symbol &other) const {return mID==other.mID;}
+        bool operator!=(const Symbol &other) const {return mID!=other.mID;}
+        bool operator<(const Symbol &other) const {return mID<other.mID;}
+
+        /// For using symbols as keys in unordered containers
+        struct Hash
+        {
+            std::size_t operator()(const Symbol &symbol) const {return symbol.mID;}
+        };
+
+        // Accessors
+        unsigned int getID() const {return mID;}
+        bool empty() const {return mID==0;}
+
+        /// The interned string. Empty if this symbol's ID was never interned in this process
+        const std::string &getString() const;
+
+    protected:
+        /// Hashes and interns a string
+        void intern(const char *string);
+
+        /// Hash of the string. 0 is the empty string
+        unsigned int mID;
+
+    private:
+};
+
+#endif // SYMBOL_H
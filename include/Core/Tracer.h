@@ -0,0 +1,135 @@
+/*
+Tracer.h
+Theodore DeRego
+Copyright 2012
+
+Records a timeline of what every thread was doing, and writes it out as Chrome trace JSON, which can be opened in
+chrome://tracing or Perfetto. Each thread records into its own ring buffer without locking. Capture is started and
+stopped at runtime, and TRACE_SCOPE costs one check of a flag while nothing is being captured. Define
+FISSION_NO_TRACE to compile the scopes out entirely.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <SFML/System/Mutex.hpp>
+
+class Tracer
+{
+    public:
+        /// Number of events each thread keeps. Once a thread's buffer is full its oldest events are overwritten
+        static const unsigned int BufferSize = 65536;
+
+        Tracer();
+        virtual ~Tracer();
+
+        /// Throws away the last capture and starts a new one
+        void start();
+        void stop();
+
+        /// Writes the last capture. Only call this while stopped. Returns false if the file couldn't be opened
+        bool write(const std::string &fileName);
+
+        /// Names the calling thread in the trace
+        void setThreadName(const std::string &name);
+
+        /// Nanoseconds since the capture started
+        long long getTime(){return getClock()-mEpoch.load(std::memory_order_relaxed);}
+
+        // Accessors
+        bool getCapturing(){return mCapturing.load(std::memory_order_relaxed);}
+
+        /// Which capture this is. Counts up from 1 every time one starts
+        unsigned int getCapture(){return mCapture.load(std::memory_order_acquire);}
+
+        static Tracer *get(){return Instance;}
+
+        /// Records the time between its construction and destruction as one event
+        class Scope
+        {
+            public:
+                /// name must outlive the capture, so it's normally a string literal
+                Scope(const char *name)
+                {
+                    mName = name;
+                    mCapture = Instance->getCapturing() ? Instance->getCapture() : 0;
+                    mStart = mCapture ? Instance->getTime() : -1;
+                }
+
+                ~Scope()
+                {
+                    if (mStart >= 0 && Instance->getCapturing())
+                        Instance->record(mName, mCapture, mStart, Instance->getTime()-mStart);
+                }
+
+            private:
+                const char *mName;
+
+                /// The capture the scope started in. Its start time means nothing to any other
+                unsigned int mCapture;
+
+                /// -1 if nothing was being captured when the scope started
+                long long mStart;
+        };
+
+    protected:
+        struct Event
+        {
+            const char *mName;
+            long long mStart;
+            long long mDuration;
+        };
+
+        /// Only the thread that owns a buffer writes to it, resetting it itself when a new capture has started
+        struct ThreadBuffer
+        {
+            unsigned int mThreadID;
+            std::string mName;
+
+            Event mEvents[BufferSize];
+
+            /// The capture the events are from. Buffers from an older one are left out when writing
+            std::atomic <unsigned int> mCapture;
+
+            /// Events written in that capture. The newest is at (mWritten-1)%BufferSize
+            std::atomic <unsigned int> mWritten;
+        };
+
+        /// Drops events from scopes that started in an earlier capture
+        void record(const char *name, unsigned int capture, long long start, long long duration);
+
+        static long long getClock(){return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();}
+
+        /// The calling thread's buffer. Creates it the first time a thread asks
+        ThreadBuffer *getThreadBuffer();
+
+        static thread_local ThreadBuffer *CurrentBuffer;
+
+        /// Every thread's buffer. Buffers are only created, never destroyed, so threads keep theirs without locking
+        std::vector <ThreadBuffer*> mBuffers;
+        sf::Mutex mBuffersMutex;
+
+        std::atomic <bool> mCapturing;
+        std::atomic <unsigned int> mCapture;
+
+        /// When the capture started, by getClock(). Set before mCapture counts the capture
+        std::atomic <long long> mEpoch;
+
+    private:
+        static Tracer *Instance;
+};
+
+#ifndef FISSION_NO_TRACE
+    #define TRACE_CONCAT_IMPL(a, b) a##b
+    #define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+    #define TRACE_SCOPE(name) Tracer::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+    #define TRACE_SCOPE(name)
+#endif
+
+#endif // TRACER_H
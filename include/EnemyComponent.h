@@ -23,7 +23,7 @@ class EnemyComponent : public Component
         int mContactCount;
         sf::Clock mContactClock; //time since last contact
 
-        GameObject *mLeader; // My leader to follow
+        Handle mLeader; // My leader to follow
         float mFollowDistance;
 
         GameState *mGameState;
@@ -2,6 +2,7 @@
 #define FISSION_H_INCLUDED
 
 #include <Core/Math.h>
+#include <Core/FramePacer.h>
 #include <Core/GameObject.h>
 #include <Core/Component.h>
 
@@ -19,6 +20,7 @@
 #include <Rendering/RenderingManager.h>
 #include <Physics/PhysicsManager.h>
 #include <Scene/SceneManager.h>
+#include <Scene/Prefab.h>
 #include <Network/NetworkManager.h>
 
 #include <Network/Chat.h>
@@ -9,19 +9,28 @@ class RenderingManager;
 class PhysicsManager;
 class SceneManager;
 class NetworkManager;
+class JobSystem;
+class FramePacer;
 
 class Game
 {
     public:
-        Game();
+        /// A headless game simulates and networks like any other, but never opens a window or touches GL. For
+        /// dedicated servers. Games built with FISSION_HEADLESS are always headless
+        Game(bool headless = false);
         virtual ~Game();
 
         virtual void run(State *state);
 
         void close(){mRunning=false;}
 
+        /// Simulation ticks per second. Rendering interpolates between ticks, so this can be lowered without judder
+        void setTickRate(float rate){mLockStep=1.f/rate;}
+
         //accessors
         int getFrameRate(){return mFrameRate;}
+        bool getHeadless(){return mHeadless;}
+        FramePacer *getFramePacer(){return mFramePacer;}
 
     protected:
         ResourceManager *mResourceManager;
@@ -31,13 +40,21 @@ class Game
         PhysicsManager *mPhysicsManager;
         SceneManager *mSceneManager;
         NetworkManager *mNetworkManager;
+        JobSystem *mJobSystem;
+        FramePacer *mFramePacer;
 
         bool mRunning;
+        bool mHeadless;
 
         int mFrameRate; //the FPS that we calculate
 
+        /// F9 presses already handled, to toggle trace captures on new ones
+        unsigned int mTracePresses;
+
+        /// F10 presses already handled, to toggle the main scene's budget report on new ones
+        unsigned int mBudgetReportPresses;
+
         float mLockStep; // The tick rate of the physics engine
-        float mLockStepAccumulator; // Accumulator for physics time processing
         float mLockStepAccumulatorRatio; // Ratio of delta time left to physics lock step
 
     private:
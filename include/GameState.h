@@ -46,6 +46,9 @@ class GameState : public State
 
         /// This client's hero. Null if this is a server
         GameObject *mHero;
+
+        /// Template for the robots spawned when someone connects
+        Prefab *mRobotPrefab;
 };
 
 #endif // GAMESTATE_H
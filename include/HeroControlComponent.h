@@ -19,10 +19,6 @@ class HeroControlComponent : public Component
 
         virtual void handlePacket(sf::Packet &packet);
 
-        virtual void onPreSolve(GameObject *object, b2Contact* contact, const b2Manifold* oldManifold);
-        virtual void onContactBegin(GameObject *object);
-        virtual void onContactEnd(GameObject *object);
-
         static Component *createComponent(GameObject *object);
 
         // Accessors
@@ -42,11 +38,15 @@ class HeroControlComponent : public Component
         sf::Vector2f mMousePosition;
         int mLMBState, mMMBState, mRMBState;
 
+        /// Makes an arm as a child object, so it follows the hero wherever the body moves it
+        Handle createArm(std::string texture, sf::Vector2f position);
+
         // Components to store
         SpriteComponent *mSpriteComponent;
         RigidBodyComponent *mBodyComponent;
 
-        SpriteComponent *mLeftArm, *mRightArm;
+        /// The arm objects. Handles, since they can be killed apart from the hero
+        Handle mLeftArm, mRightArm;
 
     private:
 };
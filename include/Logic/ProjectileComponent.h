@@ -1,9 +1,14 @@
 #ifndef PROJECTILECOMPONENT_H
 #define PROJECTILECOMPONENT_H
 
-#include <LTBL/Light/EmissiveLight.h>
 #include <Core/Component.h>
 
+namespace ltbl
+{
+    class EmissiveLight;
+    class LightSystem;
+}
+
 class ProjectileComponent : public Component
 {
     public:
@@ -26,8 +31,9 @@ class ProjectileComponent : public Component
         /// Whether or not to draw an effect
         bool mVisual;
 
-        /// Emissive light for visual bullets
+        /// Emissive light for visual bullets, and the light system of the scene it was added to
         ltbl::EmissiveLight *mEmissiveLight;
+        ltbl::LightSystem *mLightSystem;
 
     private:
 };
@@ -0,0 +1,97 @@
+/*
+BitStream.h
+Theodore DeRego
+Copyright 2012
+
+Writes and reads values packed into exactly as many bits as they need, rather than the whole bytes sf::Packet uses.
+Floats are quantized into a range with a fixed number of steps, so a position that only needs to be right to a
+sixty-fourth of a unit doesn't cost 32 bits.
+*/
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <string>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+/// The range a float is stored in and how many bits it gets
+struct Quantization
+{
+    Quantization(){mMin=0;mMax=1;mBits=32;mWrap=false;}
+    Quantization(float min, float max, unsigned int bits, bool wrap = false){mMin=min;mMax=max;mBits=bits;mWrap=wrap;}
+
+    /// The fewest bits that store values from min to max to within resolution
+    static Quantization fromResolution(float min, float max, float resolution);
+
+    /// The step value is closest to. Values outside the range are clamped, or wrapped around if mWrap is set
+    sf::Uint32 encode(float value) const;
+    float decode(sf::Uint32 step) const;
+
+    /// Rounds value to what it will be on the other end
+    float quantize(float value) const {return decode(encode(value));}
+
+    float mMin;
+    float mMax;
+    unsigned int mBits;
+
+    /// For angles. mMax is the same as mMin, so the range is split into 2^mBits steps instead of 2^mBits-1
+    bool mWrap;
+};
+
+class BitWriter
+{
+    public:
+        BitWriter();
+        virtual ~BitWriter();
+
+        /// Writes the low bits of value. Up to 32 bits at a time
+        void write(sf::Uint32 value, unsigned int bits);
+
+        /// Seven bits at a time, so small numbers stay small
+        void writeVariable(sf::Uint32 value);
+
+        void writeFloat(float value, const Quantization &quantization){write(quantization.encode(value), quantization.mBits);}
+
+        /// Appends what's been written to packet as one block, padded out to a whole byte
+        void flush(sf::Packet &packet);
+
+        unsigned int getBitCount(){return mBitCount;}
+
+    protected:
+        std::vector <sf::Uint8> mData;
+
+        /// Bits that don't make up a whole byte yet, lowest first
+        sf::Uint64 mScratch;
+        unsigned int mScratchBits;
+
+        unsigned int mBitCount;
+};
+
+/// Reads what a BitWriter flushed into a packet. The whole block comes out of the packet at once, since taking it a
+/// byte at a time through sf::Packet costs more than unpacking it
+class BitReader
+{
+    public:
+        BitReader(sf::Packet &packet);
+        virtual ~BitReader();
+
+        sf::Uint32 read(unsigned int bits);
+        sf::Uint32 readVariable();
+        float readFloat(const Quantization &quantization){return quantization.decode(read(quantization.mBits));}
+
+        /// False once something was read past the end of the packet. Everything read from then on is 0
+        bool getValid(){return mValid;}
+
+    protected:
+        std::string mData;
+        unsigned int mReadPosition;
+
+        sf::Uint64 mScratch;
+        unsigned int mScratchBits;
+
+        bool mValid;
+};
+
+#endif // BITSTREAM_H
@@ -1,10 +1,15 @@
 #ifndef NETWORKMANAGER_H
 #define NETWORKMANAGER_H
 
+#include <vector>
+
 #include <enet/enet.h>
 #include <SFML/Network.hpp>
+#include <SFML/System/Mutex.hpp>
+#include <SFML/System/Thread.hpp>
 
 #include <Core/Manager.h>
+#include <Core/Handle.h>
 
 namespace NetworkType
 {
@@ -22,15 +27,66 @@ namespace PacketType
         SCENE_CREATION,
         CREATE_OBJECT,
         COMPONENT_MESSAGE,
+        SCENE_UPDATE,
+        SNAPSHOT_ACK,
         USER_MESSAGE
     };
 };
 
+class Scene;
+class SendScheduler;
+
 struct Connector
 {
+    Connector(){mID=-1;mPeer=NULL;mScene=NULL;mAckedSnapshot=0;mScheduler=NULL;}
+
     int mID;
     std::string mIPAddress;
     ENetPeer *mPeer;
+
+    /// The scene the connector plays in. Broadcasts only reach the connectors in the scene they're sent from
+    Scene *mScene;
+
+    /// The newest snapshot the client said it received. Scene updates only hold what changed since then
+    sf::Uint32 mAckedSnapshot;
+
+    /// The GameObject the connector's view is centred on, usually its hero. Without one it sees the whole scene
+    Handle mFocus;
+
+    /// Picks what goes in each scene update to fit the connector's bandwidth. Owned by the NetworkManager
+    SendScheduler *mScheduler;
+};
+
+/// Something that happened on the network thread, waiting for the main thread to handle it
+struct NetworkEvent
+{
+    /// ENET_EVENT_TYPE_CONNECT, ENET_EVENT_TYPE_RECEIVE or ENET_EVENT_TYPE_DISCONNECT
+    int mType;
+
+    /// Connector of the peer it came from. 0 for the server on clients
+    int mConnectorID;
+
+    ENetPeer *mPeer;
+    std::string mIPAddress;
+    int mPort;
+
+    sf::Packet mPacket;
+};
+
+/// Messages waiting to go to one peer. They're framed one after another as they're sent, and cut into datagrams
+/// when the queue is flushed at the end of the update
+struct OutgoingQueue
+{
+    OutgoingQueue(){mPeer=NULL;mReliable=true;}
+
+    ENetPeer *mPeer;
+    bool mReliable;
+
+    /// Each message with its length in front
+    std::vector <char> mData;
+
+    /// Where each message ends in mData
+    std::vector <unsigned int> mEnds;
 };
 
 class GameObject;
@@ -45,17 +101,40 @@ class NetworkManager : public Manager
         void hostServer(int port);
         void connectClient(std::string ipAddress, int port);
 
+        /// Handles everything the network thread received since the last update
         virtual bool update(float dt);
 
-        void send(sf::Packet packet, int connectorID = 0, int excludeID = 0, bool reliable = true); // connectorID is only relevant to server. It is 0 to send to all clients
+        /// Queues a message. Everything queued for a peer goes out together, packed into as few datagrams as fit,
+        /// when the queues are flushed at the end of the update
+        void send(sf::Packet packet, int connectorID = 0, int excludeID = 0, bool reliable = true); // connectorID is only relevant to server. It is 0 to send to all clients in the current scene
         void sendSceneCreation(int connectorID = 0, int excludeID = 0, bool reliable = true);
         void sendGameObject(GameObject *object, int connectorID = 0, int excludeID = 0, bool reliable = true);
         void sendToComponent(sf::Packet packet, GameObject *object, Component *component, int connectorID = 0, int excludeID = 0, bool reliable = true);
 
+        /// Hands everything queued to enet and sends it. Reliable messages go before unreliable ones sent to the same peer
+        void flush();
+
         int findConnectorID(std::string IP);
         Connector findConnector(int ID);
         void removeConnector(int ID);
 
+        /// Moves a connector to another scene. Its packets are handled with that scene bound from then on
+        void setConnectorScene(int ID, Scene *scene);
+
+        /// Moves every connector in one scene to another
+        void moveConnectors(Scene *from, Scene *to);
+
+        /// Centres a connector's view on object, so scene updates only hold the objects around it. Objects coming
+        /// into and going out of view are sent as they cross the edge. NULL sends it the whole scene again
+        void setConnectorFocus(int ID, GameObject *object);
+
+        /// Objects come into a connector's view within enterRadius of its focus, and go out of it past leaveRadius
+        void setInterestRadii(float enterRadius, float leaveRadius){mInterestRadius=enterRadius;mInterestLeaveRadius=leaveRadius;}
+
+        /// Bytes per second of scene updates sent to clients that didn't say how much they can take. Clients that did
+        /// get what they asked for. Either way it's cut back while enet is throttling the link
+        void setSnapshotBandwidth(float bytesPerSecond){mSnapshotBandwidth=bytesPerSecond;}
+
         // Accessors
         int getType(){return mType;} /// Returns the network role of this application - server or client
         bool getConnected(){return mConnected;}
@@ -89,9 +168,52 @@ class NetworkManager : public Manager
         /// The list of clients if I'm a server
         std::vector <Connector> mConnectors;
 
-        /// The ID for the next connector
+        /// The ID for the next connector. Only the network thread touches this once it's running
         int mNextID;
 
+        float mInterestRadius;
+        float mInterestLeaveRadius;
+
+        float mSnapshotBandwidth;
+
+        /// Services the host on its own thread, so sending and receiving don't hold up the game
+        static void threadMain(NetworkManager *network);
+        void startThread();
+        void stopThread();
+        bool getThreadRunning();
+
+        /// Sends every connector what changed in its scene since the last snapshot it acknowledged, as much as its
+        /// bandwidth allows. Server only
+        void sendSnapshots(float dt);
+
+        /// Scene update bytes per second the connector's link can take right now
+        float getSnapshotBandwidth(const Connector &connector);
+
+        /// Sends what's queued and moves everything that arrived into mEvents. Network thread only
+        void serviceHost();
+
+        /// Adds one message to the queue for peer
+        void queueMessage(ENetPeer *peer, const char *data, unsigned int size, bool reliable);
+
+        /// Splits a datagram back into the messages packed into it, adding an event for each to events. Everything
+        /// else about the events is copied from event
+        static void unpackMessages(const enet_uint8 *data, unsigned int size, const NetworkEvent &event, std::vector <NetworkEvent> &events);
+
+        sf::Thread *mThread;
+        bool mThreadRunning;
+
+        /// enet isn't thread safe, so every use of mHost goes through this
+        sf::Mutex mHostMutex;
+
+        /// Events the network thread has received and the main thread hasn't handled. Guarded by mEventMutex,
+        /// which also guards mThreadRunning
+        std::vector <NetworkEvent> mEvents;
+        sf::Mutex mEventMutex;
+
+        /// Messages sent since the last flush. Scenes update in parallel, so this has its own mutex
+        std::vector <OutgoingQueue> mOutgoing;
+        sf::Mutex mOutgoingMutex;
+
     private:
         static NetworkManager *Instance;
 };
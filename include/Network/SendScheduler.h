@@ -0,0 +1,73 @@
+/*
+SendScheduler.h
+Theodore DeRego
+Copyright 2012
+
+Decides which scene changes a client is sent when more is changing than its link can carry. Each object waiting to
+be sent builds up priority every update, faster the nearer it is to what the client is looking at and the more its
+velocity has changed since it was last sent. The highest priorities fill the update first and whatever doesn't fit
+keeps ageing, so everything gets its turn. Updates are cut to a byte budget that refills at the client's bandwidth,
+which means a slow client gets fewer objects per update instead of a queue of updates it can't keep up with.
+*/
+
+#ifndef SENDSCHEDULER_H
+#define SENDSCHEDULER_H
+
+#include <utility>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "Network/Snapshot.h"
+
+class SendScheduler
+{
+    public:
+        SendScheduler();
+        virtual ~SendScheduler();
+
+        /// Sets what the client should end up seeing. sceneSequence is the scene snapshot it was cut from
+        void setTarget(const Snapshot &target, sf::Uint32 sceneSequence);
+
+        /// Writes the next update into packet, as a delta against acked, the newest snapshot the client
+        /// acknowledged. It holds what the client was sent before plus as many of the highest priority changes
+        /// towards the target as bandwidth, in bytes per second, allows. Objects are weighed by how far they are from
+        /// focus if hasFocus is set. Returns false if there's nothing to send or the budget is used up
+        bool buildUpdate(sf::Packet &packet, sf::Uint32 acked, float dt, float bandwidth, sf::Vector2f focus, bool hasFocus);
+
+        // Accessors
+        const Snapshot &getTarget(){return mTarget;}
+        sf::Uint32 getTargetSequence(){return mTargetSequence;}
+
+        /// The newest snapshot sent. Objects that haven't had their turn yet are as they were last sent
+        const Snapshot &getSent(){return mSent.getLatest();}
+
+        /// How far an object is from the focus before its priority builds up at half the rate
+        void setDistanceScale(float distanceScale){mDistanceScale=distanceScale;}
+
+        /// How much an object's velocity has to change to double the rate its priority builds up at
+        void setVelocityScale(float velocityScale){mVelocityScale=velocityScale;}
+
+    protected:
+        /// How fast an object's priority builds up, per second
+        float getWeight(const ObjectState &state, const ObjectState *sent, sf::Vector2f focus, bool hasFocus);
+
+        /// What the client should end up with
+        Snapshot mTarget;
+        sf::Uint32 mTargetSequence;
+
+        /// What the client was sent, to encode deltas against once it acknowledges them
+        SnapshotHistory mSent;
+
+        /// Priority of every object the client is behind on, by ID. Sorted by ID
+        std::vector <std::pair <int, float> > mPriorities;
+
+        /// Bytes that can be sent right now. Goes below 0 when an update had to be bigger than the budget
+        float mBudget;
+
+        float mDistanceScale;
+        float mVelocityScale;
+};
+
+#endif // SENDSCHEDULER_H
@@ -0,0 +1,136 @@
+/*
+Snapshot.h
+Theodore DeRego
+Copyright 2012
+
+The networked state of a scene at one moment, and the delta encoding of one snapshot against an older one. The server
+keeps its recent snapshots, and each client acknowledges the ones it receives. Every update a client gets only holds
+the fields that changed since the last snapshot it acknowledged, so an object that isn't moving costs nothing. The
+fields that are sent are quantized and bit-packed, with a range and precision set per field.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Network/BitStream.h"
+
+/// The fields of an object's state. The mask written in front of every object in a delta has bit 1 << field set for
+/// each field that follows it
+namespace SnapshotField
+{
+    enum
+    {
+        POSITION_X,
+        POSITION_Y,
+        ROTATION,
+        VELOCITY_X,
+        VELOCITY_Y,
+        ANGULAR_VELOCITY,
+        COUNT
+    };
+
+    const unsigned int ALL = (1 << COUNT)-1;
+};
+
+/// One object's networked state. Objects without a rigid body have no velocity
+struct ObjectState
+{
+    ObjectState(){mID=-1;for(unsigned int f=0;f<SnapshotField::COUNT;f++)mFields[f]=0;}
+
+    /// Mask of the fields that differ from other
+    unsigned int getChangedFields(const ObjectState &other) const;
+
+    /// Rounds every field to what the other end will get
+    void quantize();
+
+    int mID;
+
+    /// Indexed by SnapshotField
+    float mFields[SnapshotField::COUNT];
+};
+
+struct Snapshot
+{
+    Snapshot(){mSequence=0;}
+
+    /// The state of the object with the given ID. NULL if it isn't in the snapshot
+    const ObjectState *findObject(int ID) const;
+
+    /// Whether other holds the same objects in the same state
+    bool matches(const Snapshot &other) const;
+
+    /// Puts the objects in ID order, which the delta encoding relies on. Call this once all the objects are in
+    void sort();
+
+    /// Writes what changed from baseline to this snapshot. A NULL baseline writes everything. The states must
+    /// already be quantized, or changes too small to survive quantization are sent anyway
+    void serializeDelta(BitWriter &writer, const Snapshot *baseline) const;
+
+    /// Rebuilds this snapshot from baseline and a delta written by serializeDelta. Returns false if the packet ran out
+    bool deserializeDelta(BitReader &reader, const Snapshot *baseline);
+
+    /// Compares this snapshot with an older one. The indices of objects that are new or changed go in changed, with
+    /// the mask of their changed fields in changedFields if it isn't NULL, and the IDs of objects that are gone go in
+    /// removed. A NULL older snapshot counts as empty
+    void diff(const Snapshot *older, std::vector <unsigned int> &changed, std::vector <int> &removed,
+              std::vector <unsigned int> *changedFields = NULL) const;
+
+    /// How each field is packed. Both ends have to agree, so set these before connecting
+    static void setQuantization(unsigned int field, const Quantization &quantization){Quantizations[field]=quantization;}
+    static const Quantization &getQuantization(unsigned int field){return Quantizations[field];}
+
+    /// Roughly what an object with the given fields changed costs in a delta. The gap to its ID is taken to be a byte
+    static unsigned int getStateBits(unsigned int fields);
+
+    /// 0 for the empty snapshot nothing has been acknowledged against yet
+    sf::Uint32 mSequence;
+
+    /// Sorted by ID
+    std::vector <ObjectState> mObjects;
+
+    static Quantization Quantizations[SnapshotField::COUNT];
+};
+
+/// The last few snapshots a scene sent or received, to encode and decode deltas against
+class SnapshotHistory
+{
+    public:
+        /// How many snapshots are kept. A client that hasn't acknowledged anything this recent gets everything again
+        static const unsigned int HistoryLength = 32;
+
+        SnapshotHistory();
+        virtual ~SnapshotHistory();
+
+        /// Stores snapshot, replacing the oldest one kept
+        void add(const Snapshot &snapshot);
+
+        /// The snapshot with the given sequence number. Sequence 0 is always the empty snapshot. NULL if it's too old
+        const Snapshot *find(sf::Uint32 sequence);
+
+        /// The newest snapshot stored, or the empty one if there isn't any
+        const Snapshot &getLatest();
+
+        void clear();
+
+        /// A sequence number that no scene has used yet. Numbers are shared by every scene, so a client moved from
+        /// one scene to another can't mix up their snapshots
+        static sf::Uint32 allocateSequence();
+
+    protected:
+        /// A ring. Sequence numbers are shared between scenes, so they're searched for rather than indexed by
+        Snapshot mSnapshots[HistoryLength];
+
+        /// Where the next snapshot goes, and how many are stored
+        unsigned int mNextSlot;
+        unsigned int mCount;
+
+        static Snapshot Empty;
+        static std::atomic <sf::Uint32> NextSequence;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,32 @@
+/*
+ContactListener.h
+Theodore DeRego
+Copyright 2012
+
+Passes a world's contacts on to the GameObjects involved. Every Scene has its own, so worlds stepping on different
+threads never share one.
+*/
+
+#ifndef CONTACTLISTENER_H
+#define CONTACTLISTENER_H
+
+#include <Box2D/Box2D.h>
+
+class ContactListener : public b2ContactListener
+{
+    public:
+        ContactListener();
+        virtual ~ContactListener();
+
+        //Physics collision detection stuff
+        virtual void PreSolve(b2Contact* contact, const b2Manifold* oldManifold);
+        virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse);
+        virtual void BeginContact(b2Contact* contact);
+        virtual void EndContact(b2Contact* contact);
+
+    protected:
+
+    private:
+};
+
+#endif // CONTACTLISTENER_H
@@ -5,6 +5,8 @@
 
 #include <Core/Component.h>
 
+class Scene;
+
 class DragComponent : public Component
 {
     public:
@@ -26,6 +28,10 @@ class DragComponent : public Component
 
         b2MouseJoint *mMouseJoint;
 
+        /// The scene the object was in when the component was made. Kept since the object leaves the scene before
+        /// its components are destroyed
+        Scene *mScene;
+
     private:
 };
 
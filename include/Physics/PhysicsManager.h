@@ -5,47 +5,32 @@
 
 #include <Core/Manager.h>
 
-class DragComponent;
-
-class PhysicsManager : public Manager, b2ContactListener
+class PhysicsManager : public Manager
 {
     public:
         PhysicsManager();
         virtual ~PhysicsManager();
 
+        /// Steps the world of every scene. Scenes step on whichever threads the JobSystem has free
         virtual bool update(float dt);
 
-        //Physics collision detection stuff
-        virtual void PreSolve(b2Contact* contact, const b2Manifold* oldManifold);
-        virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse);
-        virtual void BeginContact(b2Contact* contact);
-        virtual void EndContact(b2Contact* contact);
-
         void resetTime(){mTime=0;}
 
         // Accessors
-        b2World *getWorld(){return mWorld;}
+        /// The world and ground body of the scene this thread is working on
+        b2World *getWorld();
+        b2Body *getGroundBody();
         int getTime(){return mTime;}
-        b2Body *getGroundBody(){return mGroundBody;}
-        DragComponent *getDragger(){return mDragger;}
 
         // Mutators
-        void setGroundBody(b2Body *body){mGroundBody=body;}
-        void setDragger(DragComponent *dragger){mDragger=dragger;}
+        void setGroundBody(b2Body *body);
 
         static PhysicsManager *get(){return Instance;}
 
     protected:
-        b2World *mWorld;
-
         /// Number of frames that have passed since the time was reset
         int mTime;
 
-        b2Body *mGroundBody;
-
-        /// The one and only mouse drag component
-        DragComponent *mDragger;
-
     private:
         static PhysicsManager *Instance;
 };
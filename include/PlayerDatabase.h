@@ -14,8 +14,9 @@ struct Player
     std::string mPassword;
 
     int mNetworkID; // This is greater than 0 if logged in, -1 if logged out
-    GameObject *mGameObject; // This will be NULL if the player isn't logged in
+    Handle mGameObject; // This will be invalid if the player isn't logged in
     sf::Vector2f mSpawnPosition; // Position to log in at
+    Scene *mScene; // The room the player is playing in. NULL if logged out
 };
 
 class PlayerDatabase
@@ -24,8 +25,9 @@ class PlayerDatabase
         PlayerDatabase();
         virtual ~PlayerDatabase();
 
-        bool createPlayer(std::string name, std::string password, int networkID);
-        void playerLogin(std::string name, std::string password, int networkID);
+        /// Players are spawned into the scene of the room they're joining
+        bool createPlayer(std::string name, std::string password, int networkID, Scene *scene);
+        void playerLogin(std::string name, std::string password, int networkID, Scene *scene);
         void playerLogout(int networkID);
 
         void spawnPlayer(Player *player);
@@ -39,10 +41,16 @@ class PlayerDatabase
         int getPlayerCount(){return mPlayers.size();}
 
     protected:
+        /// Builds the template every player is spawned from. scene holds its pooled components while it's built
+        void createPlayerPrefab(Scene *scene);
+
         std::vector <Player*> mPlayers;
 
         int mActivePlayers;
 
+        /// Everything a player's object has except its controls. Built on the first spawn
+        Prefab *mPlayerPrefab;
+
     private:
 };
 
@@ -1,10 +1,13 @@
 #ifndef GLOWINGSHAPECOMPONENT_H
 #define GLOWINGSHAPECOMPONENT_H
 
-#include <LTBL/Light/EmissiveLight.h>
-
 #include <Rendering/ShapeComponent.h>
 
+namespace ltbl
+{
+    class EmissiveLight;
+}
+
 class GlowingShapeComponent : public ShapeComponent
 {
     public:
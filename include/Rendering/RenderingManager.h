@@ -2,17 +2,21 @@
 #define RENDERINGMANAGER_H
 
 #include <SFML/Graphics.hpp>
-#include <LTBL/Light/LightSystem.h>
-#include <LTBL/Light/Light_Point.h>
-#include <LTBL/Utils.h>
 
 #include <Core/Manager.h>
 #include <Core/Math.h>
 
+namespace ltbl
+{
+    class LightSystem;
+}
+
 class RenderingManager : public Manager
 {
     public:
-        RenderingManager();
+        /// A headless RenderingManager opens no window and makes no light system, so it runs without a display or GL.
+        /// It's always headless when built with FISSION_HEADLESS, which leaves out everything that needs GL
+        RenderingManager(bool headless = false);
         virtual ~RenderingManager();
 
         virtual bool update(float dt);
@@ -23,15 +27,23 @@ class RenderingManager : public Manager
 
         // Accessors
         sf::RenderWindow *getRenderWindow(){return mRenderWindow;}
-        ltbl::LightSystem *getLightSystem(){return mLightSystem;}
+        ltbl::LightSystem *getLightSystem(){return mLightSystem;} // NULL when headless
+        bool getHeadless(){return mHeadless;}
 
         float getPTU(){return PTU;}
-        sf::Vector2f getScreenSize(){return sf::Vector2f(mRenderWindow->getSize().x, mRenderWindow->getSize().y);}
+        sf::Vector2f getScreenSize();
         sf::Vector2f getCameraPosition(){return mCameraPosition;}
-        sf::Vector2f getCameraScreenOffset(){return (sf::Vector2f(-mCameraPosition.x, mCameraPosition.y)*mPTU)+(mRenderWindow->getView().getSize()/2.f);}
+
+        /// Where the camera is drawn from, blended between the last two ticks like the objects are
+        sf::Vector2f getRenderCameraPosition(){return mPreviousCameraPosition+(mTickCameraPosition-mPreviousCameraPosition)*mInterpolation;}
+        sf::Vector2f getCameraScreenOffset();
+
+        /// How far the frame being rendered is between the last two ticks, from 0 to 1
+        float getInterpolation(){return mInterpolation;}
 
         // Mutators
         void setCameraPosition(sf::Vector2f pos){mCameraPosition=pos;}
+        void setInterpolation(float interpolation){mInterpolation=interpolation;}
 
         static RenderingManager *get(){return Instance;}
 
@@ -39,12 +51,20 @@ class RenderingManager : public Manager
         sf::RenderWindow *mRenderWindow; //the sfml render window
         ltbl::LightSystem *mLightSystem; //the lighting system
 
+        bool mHeadless;
+
         /// Pixel to unit ratio
         float mPTU;
 
         /// Position of the camera
         sf::Vector2f mCameraPosition;
 
+        /// Camera position at the end of the last two ticks
+        sf::Vector2f mPreviousCameraPosition;
+        sf::Vector2f mTickCameraPosition;
+
+        float mInterpolation;
+
     private:
         static RenderingManager *Instance;
 };
@@ -2,9 +2,13 @@
 #define SHAPECOMPONENT_H
 
 #include <SFML/Graphics/ConvexShape.hpp>
-#include <LTBL/Light/ConvexHull.h>
 #include <Core/Component.h>
 
+namespace ltbl
+{
+    class ConvexHull;
+}
+
 class ShapeComponent : public Component
 {
     public:
@@ -15,6 +19,7 @@ class ShapeComponent : public Component
         virtual void onRender(sf::RenderTarget *target, sf::RenderStates states = sf::RenderStates::Default);
 
     protected:
+        /// Only loaded to be drawn, so NULL when built with FISSION_HEADLESS
         sf::Shape *mShape;
         ltbl::ConvexHull *mLightHull;
 
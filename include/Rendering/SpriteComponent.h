@@ -21,7 +21,7 @@ class SpriteComponent : public Component
         static Component *createComponent(GameObject *object);
 
         //accessors
-        sf::Sprite *getSprite(){return mSprite;}
+        sf::Sprite *getSprite(){return mSprite;} // NULL when headless
         sf::Vector2f getFrameSize(){return sf::Vector2f(mFrameDim.x, mFrameDim.y);}
         sf::Vector2f getPosition(){return mRelativePosition;}
         float getRotation(){return mRelativeRotation;}
@@ -60,7 +60,7 @@ class SpriteComponent : public Component
         int mStartFrame;                        //The start frame of the animation loop
         int mEndFrame;                          //The end frame of the animation loop
 
-        /// Position relative to the GameObject
+        /// Position relative to the GameObject. Turns with the GameObject
         sf::Vector2f mRelativePosition;
 
         /// Rotation relative to the GameObject
@@ -0,0 +1,44 @@
+/*
+Prefab.h
+Theodore DeRego
+Copyright 2012
+
+A GameObject template baked into a binary blob. The template is built once, and every instance is created straight
+from the blob, without loading files or looking up component types by name.
+*/
+
+#ifndef PREFAB_H
+#define PREFAB_H
+
+#include <vector>
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Network/Packet.hpp>
+
+#include "Scene/SceneManager.h"
+
+class Prefab
+{
+    public:
+        /// Bakes the serializable components of object. The object isn't needed afterwards and can be released. It
+        /// doesn't have to join a scene, but it needs one set with setScene if it has pooled components
+        Prefab(GameObject *object);
+        virtual ~Prefab();
+
+        /// Creates a GameObject in scene with a copy of every baked component
+        GameObject *instantiate(Scene *scene, sf::Vector2f position = sf::Vector2f(0, 0), float rotation = 0);
+
+        // Accessors
+        unsigned int getComponentCount(){return mCreationFunctions.size();}
+
+    protected:
+        /// Creation function for each baked component, in the order they were attached
+        std::vector <ComponentCreationFunction> mCreationFunctions;
+
+        /// Every baked component serialized back to back
+        sf::Packet mData;
+
+    private:
+};
+
+#endif // PREFAB_H
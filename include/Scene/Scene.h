@@ -5,8 +5,27 @@
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Network/Packet.hpp>
 
+#include "Core/ComponentPool.h"
+#include "Core/ComponentType.h"
+#include "Core/IDAllocator.h"
+#include "Network/Snapshot.h"
+#include "Physics/ContactListener.h"
+#include "Scene/SpatialHash.h"
+#include "Scene/UpdateScheduler.h"
+
 class SceneManager;
 class GameObject;
+class DragComponent;
+class b2World;
+class b2Body;
+
+namespace ltbl
+{
+    class LightSystem;
+}
+
+/// Called for every GameObject that is destroyed, just before it is released
+typedef void (*DestructionCallback)(GameObject *);
 
 class Scene
 {
@@ -14,6 +33,22 @@ class Scene
         Scene();
         virtual ~Scene();
 
+        /// Makes a scene the one this thread works on until the binding goes out of scope. Everything that asks the
+        /// SceneManager for the current scene, the PhysicsManager for the world or a ComponentPool for its storage
+        /// gets this scene's, so several scenes can be simulated at the same time on different threads
+        class Binding
+        {
+            public:
+                Binding(Scene *scene){mPrevious=Bound;Bound=scene;}
+                ~Binding(){Bound=mPrevious;}
+
+            private:
+                Scene *mPrevious;
+        };
+
+        /// The scene bound to this thread. NULL if there isn't one
+        static Scene *getBound(){return Bound;}
+
         void initialize();
         bool update(float deltaTime);
         virtual void onRender(sf::RenderTarget *target, sf::RenderStates states = sf::RenderStates::Default);
@@ -24,19 +59,156 @@ class Scene
         void serializeCreationPacket(sf::Packet &packet);
         void deserializeCreationPacket(sf::Packet &packet);
 
-        void serializeUpdatePacket(sf::Packet &packet);
+        /// Records the state of every networked object as a new snapshot, unless nothing has changed since the last
+        /// one. Returns the sequence number of the newest snapshot. Server only
+        sf::Uint32 takeSnapshot();
+
+        /// Sequence number of the newest snapshot taken or applied. 0 if there isn't one
+        sf::Uint32 getSnapshotSequence(){return mSnapshots.getLatest().mSequence;}
+
+        /// The newest snapshot taken or applied
+        const Snapshot &getSnapshot(){return mSnapshots.getLatest();}
+
+        /// The objects of the newest snapshot within radius of center, for a client that only needs what's around it.
+        /// Objects in previous stay in until they're further than leaveRadius, so ones sitting on the edge don't keep
+        /// coming and going
+        void getInterestSnapshot(sf::Vector2f center, float radius, float leaveRadius, const Snapshot *previous, Snapshot &interest);
+
+        /// Writes the newest snapshot as a delta against baseline, the newest snapshot the client acknowledged. If
+        /// the baseline is too old to still be kept, everything is written
+        void serializeUpdatePacket(sf::Packet &packet, sf::Uint32 baseline = 0);
+
+        /// Writes any snapshot as a delta against baseline. A NULL baseline writes everything
+        static void serializeUpdatePacket(sf::Packet &packet, const Snapshot &snapshot, const Snapshot *baseline);
+
+        /// Applies an update to the objects that changed, and tells objects that came into or went out of the
+        /// client's view. Returns the sequence number for the client to acknowledge, or 0 if the packet is older than
+        /// the newest one applied or its baseline is gone
+        sf::Uint32 deserializeUpdatePacket(sf::Packet &packet);
 
         void addGameObject(GameObject *object);
+
+        /// Kills the object. It is removed and released at the end of the current or next update
         void destroyGameObject(GameObject *object);
+
+        /// Finds an object by its network ID. Stale IDs from destroyed objects return NULL
         GameObject *findGameObject(int ID);
 
+        /// Hands out a new ID for an object on the authority. Give it to the object with setID(ID, true)
+        int allocateID(){return mIDAllocator.allocate();}
+
+        /// Gives back an ID from allocateID
+        void freeID(int ID){mIDAllocator.free(ID);}
+
+        /// Moves an object in the ID index after its ID changed. Called by GameObject::setID
+        void reindexGameObject(GameObject *object, int oldID);
+
         void clear();
 
+        void addDestructionCallback(DestructionCallback callback);
+        void removeDestructionCallback(DestructionCallback callback);
+
         std::vector <GameObject*> &getGameObjects(){return mGameObjects;}
+        UpdateScheduler *getUpdateScheduler(){return &mUpdateScheduler;}
+
+        /// This scene's physics world. Every scene steps its own
+        b2World *getWorld(){return mWorld;}
+        b2Body *getGroundBody(){return mGroundBody;}
+        void setGroundBody(b2Body *body){mGroundBody=body;}
+
+        /// The component the mouse is dragging around in this scene. NULL if there isn't one
+        DragComponent *getDragger(){return mDragger;}
+        void setDragger(DragComponent *dragger){mDragger=dragger;}
+
+        /// Where this scene's lights and shadow casters go. Only the scene that gets rendered has one, so NULL
+        /// everywhere else, and on headless builds
+        ltbl::LightSystem *getLightSystem(){return mLightSystem;}
+        void setLightSystem(ltbl::LightSystem *lightSystem){mLightSystem=lightSystem;}
+
+        /// This scene's pool for T, made the first time it's asked for. Pools are made on the thread updating the
+        /// scene, like the components that go in them
+        template <typename T> ComponentPool<T> *getPool()
+        {
+            return static_cast <ComponentPool<T>*> (getPool(ComponentType::getID<T>(), &ComponentPool<T>::make));
+        }
+
+        /// The pool for the component type with the given ComponentType ID, made with factory if there isn't one
+        ComponentPoolBase *getPool(unsigned int typeID, PoolFactory factory);
+
+        /// Objects within activeRadius of an anchor or the camera are active. Sleeping objects further than
+        /// dormantRadius are dormant, and the ones in between are idle
+        void setActivityRadii(float activeRadius, float dormantRadius){mActiveRadius=activeRadius;mDormantRadius=dormantRadius;}
+
+        /// Idle objects are updated once every this many ticks
+        void setIdleInterval(unsigned int ticks){mIdleInterval=ticks;}
+
+        /// Prints the UpdateScheduler's budget report every this many ticks. 0 turns it off, which it starts as
+        void setBudgetReportInterval(unsigned int ticks){mBudgetReportInterval=ticks;mTicksSinceReport=0;}
+        unsigned int getBudgetReportInterval(){return mBudgetReportInterval;}
 
     protected:
+        /// Removes dead objects in one pass and releases them after running the destruction callbacks
+        void destroyDeadGameObjects();
+
+        /// Puts every object in an ActivityTier and tells it whether it updates this tick
+        void scheduleUpdates(float deltaTime);
+
+        void indexGameObject(GameObject *object);
+        void unindexGameObject(GameObject *object, int ID);
+
+        /// Runs the update loop of every pool in the scene
+        void updatePools(float deltaTime);
+
+        /// Builds every out of date world transform. Run before parallel updates, so reading a transform from a
+        /// worker never writes to another object's cache
+        void resolveWorldTransforms();
+
         std::vector <GameObject*> mGameObjects;
 
+        /// Objects removed from the scene this tick, waiting to be released
+        std::vector <GameObject*> mDestroyQueue;
+
+        std::vector <DestructionCallback> mDestructionCallbacks;
+
+        /// Objects by the index part of their ID. Lookups compare the whole ID, so stale generations miss
+        std::vector <GameObject*> mIDIndex;
+
+        IDAllocator mIDAllocator;
+
+        /// Activity tiering settings, in world units and ticks
+        float mActiveRadius;
+        float mDormantRadius;
+        unsigned int mIdleInterval;
+
+        /// Positions that keep the objects around them active. Gathered every tick
+        std::vector <sf::Vector2f> mActivityAnchors;
+
+        UpdateScheduler mUpdateScheduler;
+
+        unsigned int mBudgetReportInterval;
+        unsigned int mTicksSinceReport;
+
+        b2World *mWorld;
+        b2Body *mGroundBody;
+
+        /// Hands this scene's contacts to the objects involved
+        ContactListener mContactListener;
+
+        DragComponent *mDragger;
+
+        ltbl::LightSystem *mLightSystem;
+
+        /// Storage for this scene's pooled components, indexed by ComponentType ID
+        std::vector <ComponentPoolBase*> mPools;
+
+        /// Snapshots the server sent or the client received, to encode and decode deltas against
+        SnapshotHistory mSnapshots;
+
+        /// Where the objects in the newest snapshot are, for filtering it per client
+        SpatialHash mInterestGrid;
+
+        static thread_local Scene *Bound;
+
     private:
         friend class SceneManager;
 };
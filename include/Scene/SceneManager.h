@@ -2,9 +2,12 @@
 #define SCENEMANAGER_H
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "Core/ComponentType.h"
 #include "Core/Manager.h"
+#include "Core/Symbol.h"
 
 #include "Scene.h"
 
@@ -12,33 +15,80 @@ class Component;
 
 typedef Component *(*ComponentCreationFunction)(GameObject *);
 
+/// Everything the SceneManager knows about a registered component type
+struct ComponentTypeInfo
+{
+    Symbol mName;
+    ComponentCreationFunction mCreationFunction;
+
+    /// The type's ComponentType ID. SceneManager::NoTypeID if it was registered without its type
+    unsigned int mTypeID;
+
+    /// Size and alignment of the type, which its pools lay their slots out with. 0 if it was registered without them
+    unsigned int mSize;
+    unsigned int mAlignment;
+};
+
 class SceneManager : public Manager
 {
     public:
+        static const unsigned int NoTypeID = 0xFFFFFFFF;
+
         SceneManager();
         virtual ~SceneManager();
 
+        /// Updates every scene. Scenes don't share anything, so they're spread across the JobSystem
         virtual bool update(float dt);
 
-        //void saveScene(std::string fileName){mCurrentScene->save(fileName);}
-        //void loadScene(std::string fileName){mCurrentScene->load(fileName);}
+        /// Makes a new scene with its own objects, physics world and connectors, for running another match or room
+        /// in the same process. Create its objects while it's bound with Scene::Binding. Only call these between ticks
+        Scene *createScene();
+
+        /// Destroys a scene made with createScene. Its connectors go back to the main scene
+        void destroyScene(Scene *scene);
 
-        GameObject *createGameObject();
-        void addGameObject(GameObject *object){mCurrentScene->addGameObject(object);}
-        void destroyGameObject(GameObject *object){mCurrentScene->destroyGameObject(object);}
-        GameObject *findGameObject(int ID){return mCurrentScene->findGameObject(ID);}
+        //void saveScene(std::string fileName){getCurrentScene()->save(fileName);}
+        //void loadScene(std::string fileName){getCurrentScene()->load(fileName);}
 
-        void clearScene(){mCurrentScene->clear();}
+        /// Creates an object in scene, or in the current scene if it's NULL
+        GameObject *createGameObject(Scene *scene = NULL);
+        void addGameObject(GameObject *object){getCurrentScene()->addGameObject(object);}
+        void destroyGameObject(GameObject *object){getCurrentScene()->destroyGameObject(object);}
+        GameObject *findGameObject(int ID){return getCurrentScene()->findGameObject(ID);}
 
-        void registerComponentCreationFunction(std::string name, ComponentCreationFunction funcPointer);
-        ComponentCreationFunction getComponentCreationFunction(std::string name);
-        void removeComponentCreationFunction(std::string name);
+        void clearScene(){getCurrentScene()->clear();}
+
+        /// Registers T under name, along with its size and alignment. T must have a static createComponent function.
+        /// Pass a bigger size or alignment to give T's pooled components more room, such as a cache line each. Register
+        /// types before their first pool is made, since pools lay out their storage when they're made
+        template <typename T> void registerComponentType(Symbol name, unsigned int size = sizeof(T),
+                                                         unsigned int alignment = alignof(T))
+        {
+            registerComponentType(name, T::createComponent, ComponentType::getID<T>(), size, alignment);
+        }
+        void registerComponentType(Symbol name, ComponentCreationFunction funcPointer, unsigned int typeID = NoTypeID,
+                                   unsigned int size = 0, unsigned int alignment = 0);
+
+        /// The registered type with the given name. NULL if there isn't one
+        ComponentTypeInfo *getComponentType(Symbol name);
+
+        /// The registered type with the given ComponentType ID. NULL if there isn't one
+        ComponentTypeInfo *getComponentType(unsigned int typeID);
+
+        void registerComponentCreationFunction(Symbol name, ComponentCreationFunction funcPointer){registerComponentType(name, funcPointer);}
+        ComponentCreationFunction getComponentCreationFunction(Symbol name);
+        void removeComponentCreationFunction(Symbol name);
 
         void saveGameObject(GameObject *object, std::string fileName);
         GameObject *loadGameObject(std::string fileName);
 
         // Accessors
-        Scene *getCurrentScene(){return mCurrentScene;}
+        /// The scene bound to this thread, or the main scene if none is
+        Scene *getCurrentScene(){return Scene::getBound() ? Scene::getBound() : mMainScene;}
+
+        /// The first scene, which is the one that gets rendered and that new connectors join
+        Scene *getMainScene(){return mMainScene;}
+        std::vector <Scene*> &getScenes(){return mScenes;}
 
         // Mutators
 
@@ -48,11 +98,15 @@ class SceneManager : public Manager
         /// List of all the loaded scenes
         std::vector <Scene*> mScenes;
 
-        /// The scene currently being used
-        Scene *mCurrentScene;
+        /// The main scene
+        Scene *mMainScene;
+
+        /// Registered component types, keyed by type name
+        std::unordered_map <Symbol, ComponentTypeInfo, Symbol::Hash> mComponentTypes;
 
-        std::vector <ComponentCreationFunction> mComponentCreationFunctions;
-        std::vector <std::string> mComponentCreationFunctionNames;
+        /// The entries in mComponentTypes indexed by ComponentType ID, or NULL. Map entries don't move, so these stay
+        /// valid until the entry is removed
+        std::vector <ComponentTypeInfo*> mComponentTypesByID;
 
     private:
         static SceneManager *Instance;
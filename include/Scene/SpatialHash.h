@@ -0,0 +1,65 @@
+/*
+SpatialHash.h
+Theodore DeRego
+Copyright 2012
+
+Finds everything within a radius of a point without checking everything. Entries are bucketed into square cells and
+kept sorted by cell, so a query only looks at the cells the circle overlaps. It's rebuilt from scratch rather than
+updated, which suits things that are gathered up once and queried many times, like a snapshot being filtered for
+every client.
+*/
+
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <vector>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/Vector2.hpp>
+
+class SpatialHash
+{
+    public:
+        SpatialHash(float cellSize = 64.f);
+        virtual ~SpatialHash();
+
+        void clear();
+
+        /// Adds an entry. It can't be found until build() is called
+        void insert(unsigned int index, sf::Vector2f position);
+
+        /// Sorts what was inserted into cells. Call this once everything is in
+        void build();
+
+        /// Appends the index of every entry within radius of center to indices, in no particular order
+        void query(sf::Vector2f center, float radius, std::vector <unsigned int> &indices);
+
+        // Accessors
+        float getCellSize(){return mCellSize;}
+        unsigned int getEntryCount(){return mEntries.size();}
+
+        /// Only takes effect on the next build()
+        void setCellSize(float cellSize){mCellSize=cellSize;}
+
+    protected:
+        struct Entry
+        {
+            sf::Uint64 mCell;
+            unsigned int mIndex;
+            sf::Vector2f mPosition;
+
+            bool operator<(const Entry &other) const {return mCell < other.mCell;}
+        };
+
+        /// Column in the high half, row in the low half, both offset so negative cells sort before positive ones.
+        /// Cells in one column are then next to each other
+        static sf::Uint64 getCellKey(int column, int row){return ((sf::Uint64)(sf::Uint32)(column+0x80000000u) << 32) | (sf::Uint32)(row+0x80000000u);}
+        int getCellCoordinate(float position);
+
+        float mCellSize;
+
+        /// Sorted by cell once built
+        std::vector <Entry> mEntries;
+};
+
+#endif // SPATIALHASH_H
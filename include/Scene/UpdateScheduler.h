@@ -0,0 +1,96 @@
+/*
+UpdateScheduler.h
+Theodore DeRego
+Copyright 2012
+
+Decides which components update each tick. Components that ask for a lower update rate are spread across ticks so
+they don't all land on the same one, and component types can be given a time budget. A type that goes over its budget
+is updated less often until it fits again.
+*/
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <unordered_map>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Mutex.hpp>
+#include <SFML/System/Time.hpp>
+
+#include "Core/Symbol.h"
+
+class Component;
+
+class UpdateScheduler
+{
+    public:
+        /// Most a budgeted type is slowed down by, in multiples of its normal update interval
+        static const unsigned int MaxSlowdown = 8;
+
+        UpdateScheduler();
+        virtual ~UpdateScheduler();
+
+        /// Starts a tick. tickLength is the time one tick normally covers
+        void beginTick(float tickLength);
+
+        /// Adjusts the slowdown of every budgeted type from the time it took this tick
+        void endTick();
+
+        /// Whether or not the component updates this tick. If it does, time is set to what to pass to update(),
+        /// which includes the ticks it skipped. dt is the time its GameObject was scheduled with. Thread safe
+        bool isDue(Component *component, float dt, float &time);
+
+        /// Budget for all components of a type together, in milliseconds per tick. Only call this between ticks
+        void setBudget(Symbol typeName, float milliseconds);
+        void removeBudget(Symbol typeName);
+
+        /// Prints the time each budgeted type took last tick against its budget
+        void printReport();
+
+        /// Time limit for one component type
+        struct Budget
+        {
+            /// Milliseconds per tick
+            float mBudget;
+
+            /// Milliseconds spent so far this tick, and all of last tick
+            float mTime;
+            float mLastTime;
+
+            /// Components of this type update this many times less often than they ask for
+            unsigned int mSlowdown;
+        };
+
+        /// Times one update if the component's type has a budget
+        class Timer
+        {
+            public:
+                Timer(UpdateScheduler *scheduler, Component *component);
+                ~Timer();
+
+            private:
+                UpdateScheduler *mScheduler;
+                Budget *mBudget;
+                sf::Time mStart;
+        };
+
+    protected:
+        /// Looks up the budget for a component's type. NULL if it doesn't have one
+        Budget *findBudget(Component *component);
+
+        /// Ticks since the scheduler was created
+        unsigned int mTick;
+        float mTickLength;
+
+        std::unordered_map <Symbol, Budget, Symbol::Hash> mBudgets;
+
+        /// Times budgeted updates. Reading a clock is thread safe
+        sf::Clock mClock;
+
+        /// Guards the time budgeted types add up during a parallel update
+        sf::Mutex mBudgetMutex;
+
+    private:
+};
+
+#endif // UPDATESCHEDULER_H
@@ -0,0 +1,315 @@
+/*
+mainBenchmarks.cpp
+Theodore DeRego
+Copyright 2012
+
+Microbenchmarks for the engine's hot paths, built by the Benchmarks target against the release library. Nothing is
+drawn or networked, so only the managers the benchmarks need are created. Each benchmark prints its own results
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+#include <Core/GameObject.h>
+#include <Core/JobSystem.h>
+#include <Network/Snapshot.h>
+#include <Physics/PhysicsManager.h>
+#include <Scene/Scene.h>
+#include <Scene/SceneManager.h>
+
+/// Nanoseconds since start, divided between count runs
+static double getNanoseconds(std::chrono::steady_clock::time_point start, unsigned int count)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/count;
+}
+
+/// Filler components for the lookup benchmark, of a few different types so the lookup can't stop at the first one
+template <int N> struct FillerComponent : public Component
+{
+    FillerComponent(GameObject *object, Symbol name) : Component(object, name) {}
+};
+
+struct TargetComponent : public Component
+{
+    TargetComponent(GameObject *object, Symbol name) : Component(object, name) {}
+};
+
+/// getComponent by type and by name, with the component looked for added last
+static void benchComponentLookup()
+{
+    const unsigned int Lookups = 20000000;
+    const unsigned int ComponentCounts[] = {1, 8, 32};
+
+    printf("getComponent, %u lookups, target added last\n", Lookups);
+    printf("  components      typed      named\n");
+
+    for (unsigned int c = 0; c < sizeof(ComponentCounts)/sizeof(ComponentCounts[0]); c++)
+    {
+        GameObject *object = SceneManager::get()->createGameObject();
+        for (unsigned int f = 0; f+1 < ComponentCounts[c]; f++)
+        {
+            switch (f%4)
+            {
+                case 0: object->addComponent(new FillerComponent<0>(object, "Filler")); break;
+                case 1: object->addComponent(new FillerComponent<1>(object, "Filler")); break;
+                case 2: object->addComponent(new FillerComponent<2>(object, "Filler")); break;
+                default: object->addComponent(new FillerComponent<3>(object, "Filler")); break;
+            }
+        }
+        object->addComponent(new TargetComponent(object, "Target"));
+
+        Symbol name("Target");
+        unsigned int found = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int l = 0; l < Lookups; l++)
+            found += object->getComponent<TargetComponent>() != NULL;
+        double typed = getNanoseconds(start, Lookups);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned int l = 0; l < Lookups; l++)
+            found += object->getComponent<TargetComponent>(name) != NULL;
+        double named = getNanoseconds(start, Lookups);
+
+        printf("  %10u %7.1f ns %7.1f ns%s\n", ComponentCounts[c], typed, named, found == Lookups*2 ? "" : "  (lookups failed)");
+
+        SceneManager::get()->destroyGameObject(object);
+    }
+}
+
+/// Ticks of a scene where objects die and spawn all the time, at 50000 of each a second with 30 ticks a second.
+/// The kills, the spawns and Scene::update are all timed
+static void benchDestruction()
+{
+    const unsigned int ObjectCount = 20000;
+    const unsigned int ChurnPerTick = 50000/30;
+    const unsigned int Ticks = 300;
+
+    Scene *scene = SceneManager::get()->getCurrentScene();
+    scene->clear();
+    std::srand(1);
+
+    for (unsigned int o = 0; o < ObjectCount; o++)
+        SceneManager::get()->createGameObject();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < Ticks; t++)
+    {
+        std::vector <GameObject*> &objects = scene->getGameObjects();
+        for (unsigned int k = 0; k < ChurnPerTick; k++)
+        {
+            // Pick again if it's already dead, so the scene stays the same size
+            GameObject *object = objects[std::rand()%objects.size()];
+            while (!object->getAlive())
+                object = objects[std::rand()%objects.size()];
+
+            object->kill();
+        }
+        for (unsigned int k = 0; k < ChurnPerTick; k++)
+            SceneManager::get()->createGameObject();
+
+        scene->update(1.f/30.f);
+    }
+    double tick = getNanoseconds(start, Ticks)/1000000.0;
+
+    printf("Scene ticks, %u objects, %u killed and %u spawned per tick\n", ObjectCount, ChurnPerTick, ChurnPerTick);
+    printf("  %.3f ms per tick, %u objects left\n", tick, (unsigned int)scene->getGameObjects().size());
+
+    scene->clear();
+}
+
+/// A snapshot of objectCount objects with random states, already quantized like the server's
+static Snapshot makeSnapshot(unsigned int objectCount)
+{
+    Snapshot snapshot;
+    for (unsigned int o = 0; o < objectCount; o++)
+    {
+        ObjectState state;
+        state.mID = o*3+1;
+        for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+            state.mFields[f] = (std::rand()%2000)/10.f-100.f;
+        state.quantize();
+
+        snapshot.mObjects.push_back(state);
+    }
+
+    return snapshot;
+}
+
+/// Writes snapshot the way it would be without bit-packing: every ID an int and every field a float
+static void writeUnpacked(sf::Packet &packet, const Snapshot &snapshot)
+{
+    packet << sf::Uint32(snapshot.mObjects.size());
+    for (unsigned int o = 0; o < snapshot.mObjects.size(); o++)
+    {
+        packet << sf::Int32(snapshot.mObjects[o].mID);
+        for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+            packet << snapshot.mObjects[o].mFields[f];
+    }
+}
+
+/// Size and speed of the snapshot encoding, then a lossy link replicating a scene with it
+static void benchSnapshots()
+{
+    const unsigned int ObjectCount = 2000;
+    const unsigned int Runs = 200;
+
+    std::srand(1);
+    Snapshot full = makeSnapshot(ObjectCount);
+    full.mSequence = SnapshotHistory::allocateSequence();
+
+    // A tenth of the objects move along x and y
+    Snapshot moved = full;
+    moved.mSequence = SnapshotHistory::allocateSequence();
+    for (unsigned int o = 0; o < ObjectCount/10; o++)
+    {
+        ObjectState &state = moved.mObjects[(o*13)%ObjectCount];
+        state.mFields[SnapshotField::POSITION_X] += 0.5f;
+        state.mFields[SnapshotField::POSITION_Y] += 0.25f;
+        state.quantize();
+    }
+
+    sf::Packet unpackedPacket;
+    writeUnpacked(unpackedPacket, full);
+
+    BitWriter fullWriter;
+    full.serializeDelta(fullWriter, NULL);
+    sf::Packet fullPacket;
+    fullWriter.flush(fullPacket);
+
+    BitWriter deltaWriter;
+    moved.serializeDelta(deltaWriter, &full);
+    sf::Packet deltaPacket;
+    deltaWriter.flush(deltaPacket);
+
+    // Make sure it all decodes back to what went in before timing it
+    BitReader fullReader(fullPacket);
+    Snapshot fullBack;
+    BitReader deltaReader(deltaPacket);
+    Snapshot movedBack;
+    bool correct = fullBack.deserializeDelta(fullReader, NULL) && fullBack.matches(full) &&
+                   movedBack.deserializeDelta(deltaReader, &full) && movedBack.matches(moved);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int r = 0; r < Runs; r++)
+    {
+        sf::Packet packet;
+        writeUnpacked(packet, full);
+    }
+    double unpackedEncode = getNanoseconds(start, Runs*ObjectCount);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned int r = 0; r < Runs; r++)
+    {
+        BitWriter writer;
+        full.serializeDelta(writer, NULL);
+        sf::Packet packet;
+        writer.flush(packet);
+    }
+    double encode = getNanoseconds(start, Runs*ObjectCount);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned int r = 0; r < Runs; r++)
+    {
+        sf::Packet packet; // Copying fullPacket would copy where it was read up to as well
+        packet.append(fullPacket.getData(), fullPacket.getDataSize());
+        BitReader reader(packet);
+        Snapshot snapshot;
+        if (!snapshot.deserializeDelta(reader, NULL))
+            correct = false;
+    }
+    double decode = getNanoseconds(start, Runs*ObjectCount);
+
+    printf("Snapshot encoding, %u objects%s\n", ObjectCount, correct ? "" : "  (round trip failed)");
+    printf("  full update    %5.1f B/object, %5.1f B/object unpacked\n", fullPacket.getDataSize()/(float)ObjectCount,
+           unpackedPacket.getDataSize()/(float)ObjectCount);
+    printf("  x and y moved  %5.1f B/changed object\n", deltaPacket.getDataSize()/(ObjectCount/10.f));
+    printf("  encode %.1f ns/object, %.1f ns/object unpacked. Decode %.1f ns/object\n", encode, unpackedEncode, decode);
+
+    // Replicate a scene where a tenth of the objects move every frame over a link that loses a fifth of the packets
+    // each way, with acks taking 3 frames to come back
+    const unsigned int SceneObjects = 1000;
+    const unsigned int Frames = 300;
+    const unsigned int AckDelay = 3;
+    const float Loss = 0.2f;
+
+    Snapshot world = makeSnapshot(SceneObjects);
+    SnapshotHistory serverHistory;
+    SnapshotHistory clientHistory;
+    std::deque <std::pair <unsigned int, sf::Uint32> > acks; // Frame each ack arrives on, and what it acknowledges
+    sf::Uint32 acked = 0;
+    unsigned int sent = 0;
+    unsigned int mismatches = 0;
+
+    for (unsigned int f = 0; f < Frames; f++)
+    {
+        for (unsigned int o = 0; o < SceneObjects/10; o++)
+        {
+            ObjectState &state = world.mObjects[(f*131+o)%SceneObjects];
+            state.mFields[SnapshotField::POSITION_X] += 0.1f;
+            state.mFields[SnapshotField::ROTATION] += 3.f;
+            state.quantize();
+        }
+
+        world.mSequence = SnapshotHistory::allocateSequence();
+        serverHistory.add(world);
+
+        while (!acks.empty() && acks.front().first <= f)
+        {
+            if (acks.front().second > acked)
+                acked = acks.front().second;
+            acks.pop_front();
+        }
+
+        const Snapshot *baseline = serverHistory.find(acked);
+        if (!baseline) // Too old. Start the client over from nothing
+            baseline = serverHistory.find(0);
+
+        BitWriter writer;
+        writer.write(world.mSequence, 32);
+        writer.writeVariable(world.mSequence-baseline->mSequence);
+        world.serializeDelta(writer, baseline);
+        sf::Packet packet;
+        writer.flush(packet);
+        sent += packet.getDataSize();
+
+        if (std::rand() < RAND_MAX*Loss)
+            continue;
+
+        BitReader reader(packet);
+        Snapshot received;
+        received.mSequence = reader.read(32);
+        const Snapshot *clientBaseline = clientHistory.find(received.mSequence-reader.readVariable());
+        if (!clientBaseline)
+            continue;
+
+        if (!received.deserializeDelta(reader, clientBaseline) || !received.matches(world))
+            mismatches++;
+        clientHistory.add(received);
+
+        if (std::rand() >= RAND_MAX*Loss)
+            acks.push_back(std::make_pair(f+AckDelay, received.mSequence));
+    }
+
+    printf("Replication, %u objects, a tenth moving, %.0f%% loss each way, %u frames\n", SceneObjects, Loss*100,
+           Frames);
+    sf::Packet unpackedWorld;
+    writeUnpacked(unpackedWorld, world);
+    printf("  %.0f B/frame, %u B/frame for full unpacked updates, %u mismatches\n", sent/(float)Frames,
+           (unsigned int)unpackedWorld.getDataSize(), mismatches);
+}
+
+int main()
+{
+    new JobSystem;
+    new PhysicsManager;
+    new SceneManager;
+
+    benchComponentLookup();
+    benchDestruction();
+    benchSnapshots();
+
+    return 0;
+}
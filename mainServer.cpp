@@ -5,16 +5,27 @@
 #include <ctime>
 #include <fstream>
 #include <string>
-#include <LTBL/Constructs/Vec2f.h>
 
 #include <Fission.h>
 #include "GameState.h"
 #include "PlayerControlComponent.h"
 #include "EnemyComponent.h"
 
+// The DedicatedServer target defines FISSION_HEADLESS, so it runs on machines with no display or GPU
+#ifdef FISSION_HEADLESS
+    static const bool Headless = true;
+#else
+    static const bool Headless = false;
+#endif
+
 int main()
 {
-    Game *game = new Game;
+    Game *game = new Game(Headless);
+
+    // Nobody watches the server's window, so only wake up as often as the clients need
+    game->getFramePacer()->setNetworkRate(60);
+    game->getFramePacer()->setRenderRate(30);
+
     game->run(new GameState(game, NetworkType::SERVER));
 
     return 0;
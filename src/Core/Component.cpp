@@ -8,26 +8,113 @@ Component implementation
 
 #include "Core/Component.h"
 
-Component::Component(GameObject *object, std::string name)
+#include <cstdlib>
+#include <iostream>
+
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Mutex.hpp>
+
+#include "Core/ComponentType.h"
+#include "Core/ComponentPool.h"
+#include "Core/GameObject.h"
+
+std::atomic <unsigned int> ComponentType::TypeCount(0);
+ComponentType::Matcher ComponentType::Matchers[ComponentType::MaxTypes];
+
+unsigned int ComponentType::registerType(Matcher matcher)
+{
+    static sf::Mutex mutex;
+    sf::Lock lock(mutex);
+
+    unsigned int ID = TypeCount;
+    if (ID >= MaxTypes)
+    {
+        std::cout << "Too many component types. Raise ComponentType::MaxTypes\n";
+        std::abort();
+    }
+
+    Matchers[ID] = matcher;
+    TypeCount = ID+1; // Only counted once its matcher is there to be read
+
+    return ID;
+}
+
+HandleTable <Component> Component::Handles;
+
+Component::Component(GameObject *object, Symbol name)
 {
     mGameObject = object;
     mName = name;
     mTypeName = "Component";
 
     mShouldSerialize = true;
+    mParallelSafe = false;
+    mCallbacks = 0;
+    mUpdateRate = 0;
+    mSkippedTime = 0;
+
+    mPool = NULL;
+    mPoolSlot = 0;
+
+    mHandle = Handles.add(this);
 }
 
 Component::~Component()
 {
-    //dtor
+    Handles.remove(mHandle);
+}
+
+void Component::setName(Symbol name)
+{
+    mName = name;
+
+    if (mGameObject)
+        mGameObject->rebuildComponentIndex(); // Keep named lookups pointing at the right component
+}
+
+// GCC can give the function a virtual call would end up in, which tells us which callbacks a component overrides.
+// That's a GCC extension, so other compilers go without the check
+#if defined(FISSION_DEBUG) && defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpmf-conversions"
+#define CHECK_SUBSCRIPTION(callback, function) \
+    if (!getSubscribed(callback) && (void*)(this->*(&Component::function)) != (void*)(&Component::function)) \
+        std::cout << "Component " << mName.getString() << " (" << mTypeName.getString() << ") overrides " #function \
+                  << " without subscribing to it, so it will never be called\n";
+
+void Component::checkSubscriptions()
+{
+    CHECK_SUBSCRIPTION(ComponentCallback::SET_POSITION, onSetPosition)
+    CHECK_SUBSCRIPTION(ComponentCallback::SET_ROTATION, onSetRotation)
+    CHECK_SUBSCRIPTION(ComponentCallback::PRE_SOLVE, onPreSolve)
+    CHECK_SUBSCRIPTION(ComponentCallback::CONTACT_BEGIN, onContactBegin)
+    CHECK_SUBSCRIPTION(ComponentCallback::CONTACT_END, onContactEnd)
+}
+
+#undef CHECK_SUBSCRIPTION
+#pragma GCC diagnostic pop
+#else
+void Component::checkSubscriptions()
+{
+}
+#endif
+
+void Component::destroy()
+{
+    if (mPool)
+        mPool->free(this);
+    else
+        delete this;
 }
 
 void Component::serialize(sf::Packet &packet)
 {
-    packet << mName;
+    packet << mName.getString();
 }
 
 void Component::deserialize(sf::Packet &packet)
 {
-    packet >> mName;
+    std::string name;
+    packet >> name;
+    mName = name;
 }
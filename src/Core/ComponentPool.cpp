@@ -0,0 +1,58 @@
+/*
+ComponentPool.cpp
+Theodore DeRego
+Copyright 2012
+
+ComponentPool implementation
+*/
+
+#include "Core/ComponentPool.h"
+
+#include "Core/GameObject.h"
+#include "Core/Profiler.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneManager.h"
+
+ComponentPoolBase::ComponentPoolBase(Scene *scene)
+{
+    mScene = scene;
+}
+
+ComponentPoolBase::~ComponentPoolBase()
+{
+    //dtor
+}
+
+bool ComponentPoolBase::updateComponent(Component *component, UpdateFunction update)
+{
+    UpdateScheduler *scheduler = mScene->getUpdateScheduler();
+
+    float dt = component->getGameObject()->getUpdateTime();
+    float time = dt;
+    if (!scheduler->isDue(component, dt, time))
+        return true;
+
+    UpdateScheduler::Timer timer(scheduler, component);
+    PROFILE_COMPONENT(component, ProfileEvent::UPDATE);
+    return update(component, time);
+}
+
+void ComponentPoolBase::updateParallelJob(void *data, unsigned int begin, unsigned int end)
+{
+    ComponentPoolBase *pool = (ComponentPoolBase*)data;
+    Scene::Binding binding(pool->mScene);
+
+    pool->updateParallel(begin, end);
+}
+
+unsigned int ComponentPoolBase::getRegisteredSize(unsigned int typeID, unsigned int size)
+{
+    ComponentTypeInfo *type = SceneManager::get() ? SceneManager::get()->getComponentType(typeID) : NULL;
+    return type && type->mSize ? type->mSize : size;
+}
+
+unsigned int ComponentPoolBase::getRegisteredAlignment(unsigned int typeID, unsigned int alignment)
+{
+    ComponentTypeInfo *type = SceneManager::get() ? SceneManager::get()->getComponentType(typeID) : NULL;
+    return type && type->mAlignment ? type->mAlignment : alignment;
+}
@@ -0,0 +1,155 @@
+/*
+FramePacer.cpp
+Theodore DeRego
+Copyright 2012
+
+FramePacer implementation
+*/
+
+#include "Core/FramePacer.h"
+
+#ifdef _WIN32
+    #include <chrono>
+
+    #include <SFML/System/Sleep.hpp>
+#else
+    #include <cerrno>
+    #include <time.h>
+#endif
+
+/// Whether or not something that runs every interval is due. Moves next on to its next deadline if it is
+static bool takeDue(long long now, long long interval, long long &next)
+{
+    if (interval == 0) // Runs every frame
+        return true;
+
+    if (now < next)
+        return false;
+
+    next += interval;
+    if (next <= now) // Fell more than a whole interval behind - skip ahead rather than running it every frame to catch up
+        next = now+interval;
+
+    return true;
+}
+
+FramePacer::FramePacer()
+{
+    mTickInterval = toInterval(30);
+    mNetworkInterval = 0;
+    mRenderInterval = 0;
+    mRendering = true;
+    mMinFrameInterval = toInterval(1000);
+    mMaxTicksPerFrame = 5;
+    mSpinTime = 250000; // Linux usually wakes within a tenth of a millisecond, Windows within a millisecond or two
+
+    mDroppedTicks = 0;
+
+    reset();
+}
+
+FramePacer::~FramePacer()
+{
+    //dtor
+}
+
+void FramePacer::beginFrame()
+{
+    if (mLastFrame < 0)
+    {
+        long long now = getTime();
+        mLastFrame = now;
+        mNextNetwork = now;
+        mNextRender = now;
+        mLastNetwork = now;
+    }
+    else
+        sleepUntil(getNextFrameTime());
+
+    long long now = getTime();
+    mFrameTime = now-mLastFrame;
+    mLastFrame = now;
+
+    // Run however many ticks have built up, but don't let a slow frame make the next one slower still
+    mAccumulator += mFrameTime;
+    mTickCount = mAccumulator/mTickInterval;
+    if (mTickCount > mMaxTicksPerFrame)
+    {
+        mDroppedTicks += mTickCount-mMaxTicksPerFrame;
+        mTickCount = mMaxTicksPerFrame;
+        mAccumulator = mAccumulator%mTickInterval+mTickCount*mTickInterval;
+    }
+    mAccumulator -= mTickCount*mTickInterval;
+
+    mNetworkDue = takeDue(now, mNetworkInterval, mNextNetwork);
+    if (mNetworkDue)
+    {
+        mNetworkTime = now-mLastNetwork;
+        mLastNetwork = now;
+    }
+
+    mRenderDue = mRendering && takeDue(now, mRenderInterval, mNextRender);
+}
+
+void FramePacer::reset()
+{
+    mLastFrame = -1;
+    mAccumulator = 0;
+
+    mTickCount = 0;
+    mNetworkDue = false;
+    mRenderDue = false;
+    mFrameTime = 0;
+    mNetworkTime = 0;
+}
+
+long long FramePacer::getTime()
+{
+    #ifdef _WIN32
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    #else
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec*1000000000LL+now.tv_nsec;
+    #endif
+}
+
+long long FramePacer::getNextFrameTime()
+{
+    // The next tick is due once the accumulator fills up
+    long long next = mLastFrame+mTickInterval-mAccumulator;
+
+    if (mNetworkInterval > 0 && mNextNetwork < next)
+        next = mNextNetwork;
+    if (mRendering && mRenderInterval > 0 && mNextRender < next)
+        next = mNextRender;
+
+    // Something runs every frame, so only the frame rate limit holds the next frame back
+    if (mNetworkInterval == 0 || (mRendering && mRenderInterval == 0))
+    {
+        long long limit = mLastFrame+mMinFrameInterval;
+        if (limit < next)
+            next = limit;
+    }
+
+    return next;
+}
+
+void FramePacer::sleepUntil(long long time)
+{
+    long long wake = time-mSpinTime;
+    if (wake > getTime())
+    {
+        #ifdef _WIN32
+            sf::sleep(sf::microseconds((wake-getTime())/1000));
+        #else
+            // Sleeping until an absolute time means being woken early by a signal doesn't push the deadline back
+            timespec deadline;
+            deadline.tv_sec = wake/1000000000LL;
+            deadline.tv_nsec = wake%1000000000LL;
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+        #endif
+    }
+
+    while (getTime() < time); // The tail is short enough to spin through
+}
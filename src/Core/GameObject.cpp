@@ -8,15 +8,74 @@ GameObject implementation
 
 #include "Core/GameObject.h"
 
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Mutex.hpp>
+
+#include <Core/Profiler.h>
+#include <Core/Slab.h>
+#include <Scene/Scene.h>
 #include <Scene/SceneManager.h>
 
+HandleTable <GameObject> GameObject::Handles;
+
+/// Storage for GameObjects made with GameObject::create. Scenes on other threads make objects too, so it's guarded
+struct ObjectSlab
+{
+    Slab <GameObject> mSlab;
+    sf::Mutex mMutex;
+};
+
+/// Never freed, like the managers
+static ObjectSlab *getObjectSlab()
+{
+    static ObjectSlab *Objects = new ObjectSlab;
+    return Objects;
+}
+
+/// Held while a type index grows during a lookup. Lookups of new types are rare, so one lock does for every object
+static sf::Mutex &getTypeIndexMutex()
+{
+    static sf::Mutex *Mutex = new sf::Mutex;
+    return *Mutex;
+}
+
 GameObject::GameObject()
 {
+    mHandle = Handles.add(this);
+
+    mSlabAllocated = false;
+    mSlabSlot = 0;
+
+    mID = -1;
+    mAllocatedID = false;
+    mScene = NULL;
+
     mAlive = true;
 
     mSyncNetwork = false; // By default, don't sync over the network
 
+    mActivityTier = ActivityTier::ACTIVE;
+    mAlwaysActive = false;
+    mActivityAnchor = false;
+    mWakeRequested = false;
+    mUpdateDue = true;
+    mUpdateTime = 0;
+    mSkippedTime = 0;
+    mSkippedTicks = 0;
+
     mRotation = 0;
+
+    mTypeIndex = NULL;
+
+    mParent = NULL;
+    mWorldRotation = 0;
+    mWorldDirty = true;
+    mPreviousWorldRotation = 0;
+    mHasPreviousTransform = false;
 }
 
 GameObject::~GameObject()
@@ -28,6 +87,47 @@ GameObject::~GameObject()
         c--;
         component->release();
     }
+
+    delete mTypeIndex.load();
+    for (unsigned int i = 0; i < mRetiredTypeIndices.size(); i++)
+        delete mRetiredTypeIndices[i];
+
+    // Parents and children die in the same pass, in any order
+    if (mParent)
+        mParent->removeChild(this);
+    for (unsigned int c = 0; c < mChildren.size(); c++)
+    {
+        mChildren[c]->mParent = NULL;
+        mChildren[c]->setWorldDirty();
+    }
+
+    Handles.remove(mHandle);
+}
+
+GameObject *GameObject::create()
+{
+    ObjectSlab *objects = getObjectSlab();
+    sf::Lock lock(objects->mMutex);
+
+    unsigned int slot = objects->mSlab.create();
+
+    GameObject *object = objects->mSlab.get(slot);
+    object->mSlabAllocated = true;
+    object->mSlabSlot = slot;
+
+    return object;
+}
+
+void GameObject::destroy()
+{
+    if (mSlabAllocated)
+    {
+        ObjectSlab *objects = getObjectSlab();
+        sf::Lock lock(objects->mMutex);
+        objects->mSlab.free(mSlabSlot);
+    }
+    else
+        delete this;
 }
 
 void GameObject::serialize(sf::Packet &packet)
@@ -46,7 +146,7 @@ void GameObject::serialize(sf::Packet &packet)
     {
         if (mComponents[c]->getShouldSerialize())
         {
-            packet << mComponents[c]->getTypeName();
+            packet << sf::Uint32(mComponents[c]->getTypeName().getID()); // Type names are well known, so only the ID is sent
             mComponents[c]->serialize(packet);
         }
     }
@@ -54,20 +154,29 @@ void GameObject::serialize(sf::Packet &packet)
 
 void GameObject::deserialize(sf::Packet &packet)
 {
-    packet >> mID;
+    int ID;
+    packet >> ID;
+    setID(ID);
 
+    deserializeComponents(packet);
+}
+
+void GameObject::deserializeComponents(sf::Packet &packet)
+{
     // Get all the components
     int componentCount;
-    std::string componentType;
+    sf::Uint32 componentType;
 
     packet >> componentCount;
     for (int c = 0; c < componentCount; c++)
     {
-        packet >> componentType;
+        if (!(packet >> componentType)) // Ran out of data, so the count was bad
+            return;
 
-        if (SceneManager::get()->getComponentCreationFunction(componentType) != NULL)
+        ComponentCreationFunction function = SceneManager::get()->getComponentCreationFunction(Symbol::fromID(componentType));
+        if (function != NULL)
         {
-            Component *component = SceneManager::get()->getComponentCreationFunction(componentType)(this);
+            Component *component = function(this);
             component->deserialize(packet);
             addComponent(component);
         }
@@ -79,58 +188,151 @@ void GameObject::deserialize(sf::Packet &packet)
     }
 }
 
+void GameObject::setID(int ID, bool allocated)
+{
+    int oldID = mID;
+    if (mScene && mAllocatedID && oldID != ID) // Replaced, like by the ID the server gave it
+        mScene->freeID(oldID);
+
+    mID = ID;
+    mAllocatedID = allocated;
+
+    if (mScene)
+        mScene->reindexGameObject(this, oldID);
+}
+
 bool GameObject::update(float dt)
 {
     for (unsigned int c = 0; c < mComponents.size(); c++)
     {
+        //pooled components are updated by their pool, parallel safe ones by updateParallel
+        if (mComponents[c]->getPooled() || mComponents[c]->getParallelSafe())
+            continue;
+
         //update the components
-        if (!mComponents[c]->update(dt))
+        if (!updateComponent(mComponents[c], dt))
+            mDeadComponents.push_back(mComponents[c]); //if the component doesn't want to live, end his suffering after the loop
+    }
+
+    if (mDeadComponents.size() > 0)
+    {
+        // Drop the dead components in one pass, keeping the order of the rest
+        unsigned int alive = 0;
+        for (unsigned int c = 0; c < mComponents.size(); c++)
         {
-            //if the component doesn't want to live, end his suffering
-            mComponents[c]->release();
-            mComponents.erase(mComponents.begin()+c);
-            c--;
+            if (std::find(mDeadComponents.begin(), mDeadComponents.end(), mComponents[c]) == mDeadComponents.end())
+                mComponents[alive++] = mComponents[c];
         }
+        mComponents.resize(alive);
+
+        rebuildComponentIndex();
+
+        for (unsigned int c = 0; c < mDeadComponents.size(); c++)
+            mDeadComponents[c]->release();
+        mDeadComponents.clear();
     }
 
     return mAlive;
 }
 
+bool GameObject::updateComponent(Component *component, float dt)
+{
+    // Nothing schedules objects outside of a scene
+    UpdateScheduler *scheduler = mScene ? mScene->getUpdateScheduler() : NULL;
+
+    float time = dt;
+    if (scheduler && !scheduler->isDue(component, dt, time))
+        return true;
+
+    UpdateScheduler::Timer timer(scheduler, component);
+    PROFILE_COMPONENT(component, ProfileEvent::UPDATE);
+    return component->update(time);
+}
+
+void GameObject::updateParallel(float dt)
+{
+    for (unsigned int c = 0; c < mComponents.size(); c++)
+    {
+        if (mComponents[c]->getPooled() || !mComponents[c]->getParallelSafe())
+            continue;
+
+        if (!updateComponent(mComponents[c], dt))
+            mDeadComponents.push_back(mComponents[c]); // Only the main thread may remove components
+    }
+}
+
 void GameObject::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
     for (unsigned int c = 0; c < mComponents.size(); c++)
     {
+        PROFILE_COMPONENT(mComponents[c], ProfileEvent::RENDER);
         mComponents[c]->onRender(target, states);
     }
 }
 
 void GameObject::onPreSolve(GameObject *object, b2Contact* contact, const b2Manifold* oldManifold)
 {
-    for (unsigned int c = 0; c < mComponents.size(); c++)
+    std::vector <Component*> &subscribers = mSubscribers[ComponentCallback::PRE_SOLVE];
+    for (unsigned int c = 0; c < subscribers.size(); c++)
     {
-        mComponents[c]->onPreSolve(object, contact, oldManifold);
+        PROFILE_COMPONENT(subscribers[c], ProfileEvent::CONTACT);
+        subscribers[c]->onPreSolve(object, contact, oldManifold);
     }
 }
 
 void GameObject::onContactBegin(GameObject *object)
 {
-    for (unsigned int c = 0; c < mComponents.size(); c++)
+    std::vector <Component*> &subscribers = mSubscribers[ComponentCallback::CONTACT_BEGIN];
+    for (unsigned int c = 0; c < subscribers.size(); c++)
     {
-        mComponents[c]->onContactBegin(object);
+        PROFILE_COMPONENT(subscribers[c], ProfileEvent::CONTACT);
+        subscribers[c]->onContactBegin(object);
     }
 }
 
 void GameObject::onContactEnd(GameObject *object)
+{
+    std::vector <Component*> &subscribers = mSubscribers[ComponentCallback::CONTACT_END];
+    for (unsigned int c = 0; c < subscribers.size(); c++)
+    {
+        PROFILE_COMPONENT(subscribers[c], ProfileEvent::CONTACT);
+        subscribers[c]->onContactEnd(object);
+    }
+}
+
+void GameObject::onDestroy()
+{
+    for (unsigned int c = 0; c < mComponents.size(); c++)
+    {
+        mComponents[c]->onDestroy();
+    }
+}
+
+void GameObject::onNetworkEnter()
+{
+    for (unsigned int c = 0; c < mComponents.size(); c++)
+    {
+        mComponents[c]->onNetworkEnter();
+    }
+}
+
+void GameObject::onNetworkLeave()
 {
     for (unsigned int c = 0; c < mComponents.size(); c++)
     {
-        mComponents[c]->onContactEnd(object);
+        mComponents[c]->onNetworkLeave();
     }
 }
 
 Component *GameObject::addComponent(Component *component)
 {
     mComponents.push_back(component);
+
+    indexComponentTypes(component);
+    mNameIndex.insert(std::make_pair(component->getName(), component)); // Doesn't replace an existing name
+    subscribeComponent(component);
+    component->checkSubscriptions();
+
     return component;
 }
 
@@ -147,28 +349,273 @@ void GameObject::removeComponent(Component *component)
             c--;
         }
     }
+
+    rebuildComponentIndex();
+}
+
+void GameObject::rebuildComponentIndex()
+{
+    delete mTypeIndex.load();
+    mTypeIndex = NULL;
+    indexComponentTypes(NULL);
+
+    mNameIndex.clear();
+    for (unsigned int e = 0; e < ComponentCallback::COUNT; e++)
+        mSubscribers[e].clear();
+
+    for (unsigned int c = 0; c < mComponents.size(); c++)
+    {
+        mNameIndex.insert(std::make_pair(mComponents[c]->getName(), mComponents[c])); // First component with a name wins
+        subscribeComponent(mComponents[c]);
+    }
+}
+
+void GameObject::indexComponentTypes(Component *added)
+{
+    // Nothing can be looking components up while they change, so the old indices can go
+    for (unsigned int i = 0; i < mRetiredTypeIndices.size(); i++)
+        delete mRetiredTypeIndices[i];
+    mRetiredTypeIndices.clear();
+
+    TypeIndex *index = mTypeIndex.load();
+    if (!index)
+    {
+        index = new TypeIndex;
+        mTypeIndex = index;
+    }
+
+    // Types seen for the first time are checked against every component, the new one included
+    unsigned int indexedCount = index->size();
+    fillTypeIndex(index, indexedCount, ComponentType::getTypeCount());
+
+    // The others only need checking against the new component, which may be the first of its types
+    if (added)
+    {
+        for (unsigned int t = 0; t < indexedCount; t++)
+        {
+            if (!(*index)[t] && ComponentType::isType(added, t))
+                (*index)[t] = added;
+        }
+    }
+}
+
+Component *GameObject::indexNewType(unsigned int typeID)
+{
+    sf::Lock lock(getTypeIndexMutex());
+
+    // Another thread may have grown it while this one waited
+    TypeIndex *index = mTypeIndex.load(std::memory_order_acquire);
+    if (!index || typeID >= index->size())
+    {
+        TypeIndex *grown = index ? new TypeIndex(*index) : new TypeIndex;
+        fillTypeIndex(grown, grown->size(), ComponentType::getTypeCount());
+        mTypeIndex.store(grown, std::memory_order_release);
+
+        if (index)
+            mRetiredTypeIndices.push_back(index);
+        index = grown;
+    }
+
+    return (*index)[typeID];
+}
+
+void GameObject::fillTypeIndex(TypeIndex *index, unsigned int begin, unsigned int end)
+{
+    if (end <= begin)
+        return;
+
+    index->resize(end, NULL);
+    for (unsigned int t = begin; t < end; t++)
+    {
+        for (unsigned int c = 0; c < mComponents.size() && !(*index)[t]; c++)
+        {
+            if (ComponentType::isType(mComponents[c], t))
+                (*index)[t] = mComponents[c];
+        }
+    }
+}
+
+ComponentPoolBase *GameObject::getPool(unsigned int typeID, PoolFactory factory)
+{
+    assert(mScene && "Pooled components need their GameObject in a scene");
+    return mScene->getPool(typeID, factory);
+}
+
+void GameObject::subscribeComponent(Component *component)
+{
+    for (unsigned int e = 0; e < ComponentCallback::COUNT; e++)
+    {
+        if (component->getSubscribed(e))
+            mSubscribers[e].push_back(component);
+    }
 }
 
 void GameObject::setPosition(sf::Vector2f position, Component *caller)
 {
     mPosition = position;
+    setWorldDirty();
 
-    for (unsigned int c = 0; c < mComponents.size(); c++)
+    if (!caller) // Moved from outside, like a teleport or a network update
+        wake();
+
+    std::vector <Component*> &subscribers = mSubscribers[ComponentCallback::SET_POSITION];
+    for (unsigned int c = 0; c < subscribers.size(); c++)
     {
         //make sure the component who called this doesn't have his position set - that would be redundant
-        if (mComponents[c] != caller)
-            mComponents[c]->onSetPosition(position);
+        if (subscribers[c] != caller)
+            subscribers[c]->onSetPosition(position);
     }
 }
 
 void GameObject::setRotation(float rotation, Component *caller)
 {
     mRotation = rotation;
+    setWorldDirty();
 
-    for (unsigned int c = 0; c < mComponents.size(); c++)
+    if (!caller)
+        wake();
+
+    std::vector <Component*> &subscribers = mSubscribers[ComponentCallback::SET_ROTATION];
+    for (unsigned int c = 0; c < subscribers.size(); c++)
     {
         //make sure the component who called this doesn't have his position set - that would be redundant
-        if (mComponents[c] != caller)
-            mComponents[c]->onSetRotation(rotation);
+        if (subscribers[c] != caller)
+            subscribers[c]->onSetRotation(rotation);
+    }
+}
+
+void GameObject::scheduleUpdate(int tier, float dt, unsigned int idleInterval)
+{
+    mActivityTier = tier;
+    mWakeRequested = false;
+
+    if (tier == ActivityTier::ACTIVE || (tier == ActivityTier::IDLE && mSkippedTicks+1 >= idleInterval))
+    {
+        // Catch up on the time spent idle
+        mUpdateDue = true;
+        mUpdateTime = mSkippedTime+dt;
+        mSkippedTime = 0;
+        mSkippedTicks = 0;
+    }
+    else if (tier == ActivityTier::IDLE)
+    {
+        mUpdateDue = false;
+        mSkippedTime += dt;
+        mSkippedTicks++;
     }
+    else // Time stops for dormant objects
+    {
+        mUpdateDue = false;
+        mSkippedTime = 0;
+        mSkippedTicks = 0;
+    }
+}
+
+void GameObject::kill()
+{
+    mAlive = false;
+
+    for (unsigned int c = 0; c < mChildren.size(); c++)
+        mChildren[c]->kill();
+}
+
+void GameObject::addChild(GameObject *child)
+{
+    if (child->mParent)
+        child->mParent->removeChild(child);
+
+    child->mParent = this;
+    mChildren.push_back(child);
+
+    child->setWorldDirty();
+}
+
+void GameObject::removeChild(GameObject *child)
+{
+    for (unsigned int c = 0; c < mChildren.size(); c++)
+    {
+        if (mChildren[c] == child)
+        {
+            mChildren.erase(mChildren.begin()+c);
+            child->mParent = NULL;
+
+            child->setWorldDirty();
+            return;
+        }
+    }
+}
+
+const sf::Transform &GameObject::getWorldTransform()
+{
+    if (!mWorldDirty)
+        return mWorldTransform;
+
+    sf::Transform local;
+    local.translate(mPosition);
+    local.rotate(mRotation);
+
+    if (mParent) // The parent's transform is built first, so a clean object never has a dirty parent
+    {
+        mWorldTransform = mParent->getWorldTransform()*local;
+        mWorldRotation = mParent->mWorldRotation+mRotation;
+    }
+    else
+    {
+        mWorldTransform = local;
+        mWorldRotation = mRotation;
+    }
+
+    mWorldDirty = false;
+    return mWorldTransform;
+}
+
+sf::Vector2f GameObject::getRenderPosition(float alpha)
+{
+    sf::Vector2f current = getWorldPosition();
+    if (!mHasPreviousTransform)
+        return current;
+
+    return mPreviousWorldPosition+(current-mPreviousWorldPosition)*alpha;
+}
+
+float GameObject::getRenderRotation(float alpha)
+{
+    float current = getWorldRotation();
+    if (!mHasPreviousTransform)
+        return current;
+
+    // Turn the short way round
+    float delta = fmodf(current-mPreviousWorldRotation, 360.f);
+    if (delta > 180.f)
+        delta -= 360.f;
+    else if (delta < -180.f)
+        delta += 360.f;
+
+    return mPreviousWorldRotation+delta*alpha;
+}
+
+sf::Transform GameObject::getRenderTransform(float alpha)
+{
+    sf::Transform transform;
+    transform.translate(getRenderPosition(alpha));
+    transform.rotate(getRenderRotation(alpha));
+
+    return transform;
+}
+
+void GameObject::storePreviousTransform()
+{
+    mPreviousWorldPosition = getWorldPosition();
+    mPreviousWorldRotation = getWorldRotation();
+    mHasPreviousTransform = true;
+}
+
+void GameObject::setWorldDirty()
+{
+    if (mWorldDirty) // Already dirty, so the children are too
+        return;
+
+    mWorldDirty = true;
+    for (unsigned int c = 0; c < mChildren.size(); c++)
+        mChildren[c]->setWorldDirty();
 }
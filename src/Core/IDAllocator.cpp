@@ -0,0 +1,71 @@
+/*
+IDAllocator.cpp
+Theodore DeRego
+Copyright 2012
+
+IDAllocator implementation
+*/
+
+#include "Core/IDAllocator.h"
+
+#include <iostream>
+
+IDAllocator::IDAllocator()
+{
+    //ctor
+}
+
+IDAllocator::~IDAllocator()
+{
+    //dtor
+}
+
+int IDAllocator::allocate()
+{
+    unsigned int index;
+    if (mFreeIndices.size() >= MinFreeIndices || (!mFreeIndices.empty() && mGenerations.size() > IndexMask))
+    {
+        // The index freed longest ago, so each one goes round every other free index before it's used again
+        index = mFreeIndices.front();
+        mFreeIndices.pop_front();
+    }
+    else
+    {
+        index = mGenerations.size();
+        if (index > IndexMask) // It would spill into the generation and alias another ID
+        {
+            std::cout << "Out of GameObject IDs: " << index << " are in use\n";
+            return -1;
+        }
+
+        mGenerations.push_back(1); // Generation 0 is skipped so no ID is ever 0
+        mUsed.push_back(false);
+    }
+
+    mUsed[index] = true;
+    return (int)((mGenerations[index] << IndexBits) | index);
+}
+
+void IDAllocator::free(int ID)
+{
+    if (!isCurrent(ID))
+        return;
+
+    unsigned int index = getIndex(ID);
+    mUsed[index] = false;
+
+    mGenerations[index] = (mGenerations[index]+1) & GenerationMask;
+    if (mGenerations[index] == 0) // Skip generation 0 when it wraps
+        mGenerations[index] = 1;
+
+    mFreeIndices.push_back(index);
+}
+
+bool IDAllocator::isCurrent(int ID)
+{
+    if (ID <= 0)
+        return false;
+
+    unsigned int index = getIndex(ID);
+    return index < mGenerations.size() && mUsed[index] && mGenerations[index] == getGeneration(ID);
+}
@@ -12,7 +12,10 @@ InputManager::InputManager(sf::Window *window)
 
     // All the keys are up by default
     for (int k = 0; k < sf::Keyboard::KeyCount; k++)
+    {
         mKeyStates[k] = ButtonState::UP;
+        mKeyPressCounts[k] = 0;
+    }
 
     mMouseState.mLMBState = ButtonState::UP;
     mMouseState.mMMBState = ButtonState::UP;
@@ -52,11 +55,12 @@ bool InputManager::update(float dt)
     else if (mMouseState.mRMBState == ButtonState::RELEASED)
         mMouseState.mRMBState = ButtonState::UP;
 
-    // Handle new events
+    // Handle new events. The headless build has no windows to get them from
+    #ifndef FISSION_HEADLESS
     sf::Event event;
 
-    //while there are pending events...
-    while (mWindow->pollEvent(event))
+    //while there are pending events... A headless game has no window, so its input just stays up
+    while (mWindow && mWindow->pollEvent(event))
     {
         //check the type of the event...
         switch (event.type)
@@ -70,6 +74,7 @@ bool InputManager::update(float dt)
             case sf::Event::KeyPressed:
             {
                 mKeyStates[event.key.code] = ButtonState::PRESSED;
+                mKeyPressCounts[event.key.code]++;
                 break;
             }
 
@@ -133,6 +138,7 @@ bool InputManager::update(float dt)
                 break;
         }
     }
+    #endif
 
     return true;
 }
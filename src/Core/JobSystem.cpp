@@ -0,0 +1,259 @@
+/*
+JobSystem.cpp
+Theodore DeRego
+Copyright 2012
+
+JobSystem implementation
+*/
+
+#include "Core/JobSystem.h"
+
+#include <sstream>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include <SFML/System/Lock.hpp>
+
+#include "Core/Tracer.h"
+
+JobSystem *JobSystem::Instance = NULL;
+thread_local unsigned int JobSystem::CurrentQueue = 0;
+
+static unsigned int getHardwareThreadCount()
+{
+    #ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+    #else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+    #endif
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+    Instance = this;
+
+    if (workerCount == 0)
+    {
+        unsigned int hardwareThreads = getHardwareThreadCount();
+        workerCount = hardwareThreads > 1 ? hardwareThreads-1 : 0; // The main thread is the last one
+    }
+
+    mRunning = true;
+    mQueuedJobs = 0;
+
+    mQueues.push_back(new JobQueue); // The main thread's queue
+    for (unsigned int w = 0; w < workerCount; w++)
+    {
+        mQueues.push_back(new JobQueue);
+
+        Worker *worker = new Worker;
+        worker->mJobSystem = this;
+        worker->mQueue = w+1;
+        worker->mThread = new sf::Thread(&JobSystem::workerMain, worker);
+        mWorkers.push_back(worker);
+    }
+
+    for (unsigned int w = 0; w < mWorkers.size(); w++)
+        mWorkers[w]->mThread->launch();
+}
+
+JobSystem::~JobSystem()
+{
+    mWakeMutex.lock();
+    mRunning = false;
+    mWakeMutex.unlock();
+
+    wakeSleepers();
+
+    for (unsigned int w = 0; w < mWorkers.size(); w++)
+    {
+        mWorkers[w]->mThread->wait();
+        delete mWorkers[w]->mThread;
+        delete mWorkers[w];
+    }
+
+    for (unsigned int q = 0; q < mQueues.size(); q++)
+        delete mQueues[q];
+
+    if (Instance == this)
+        Instance = NULL;
+}
+
+void JobSystem::parallelFor(unsigned int count, unsigned int batchSize, JobFunction function, void *data)
+{
+    if (batchSize == 0)
+        batchSize = 1;
+
+    if (mWorkers.size() == 0 || count <= batchSize) // Not worth handing out
+    {
+        if (count > 0)
+            function(data, 0, count);
+        return;
+    }
+
+    std::atomic <unsigned int> remaining;
+    dispatch(count, batchSize, function, data, &remaining);
+    wait(&remaining);
+}
+
+void JobSystem::dispatch(unsigned int count, unsigned int batchSize, JobFunction function, void *data,
+                         std::atomic <unsigned int> *remaining)
+{
+    if (batchSize == 0)
+        batchSize = 1;
+
+    unsigned int batchCount = (count+batchSize-1)/batchSize;
+    remaining->store(batchCount);
+    if (batchCount == 0)
+        return;
+
+    // Counted before the jobs go in, so the count can't drop below 0 when they're taken straight away. Threads that
+    // decide to sleep from here on see it and don't, and the ones that already decided are woken below
+    mQueuedJobs += batchCount;
+
+    // Deal the batches out round robin so every thread starts with work in its own queue. The calling thread's own
+    // queue gets the first batch, since it goes on to wait for them
+    unsigned int queue = CurrentQueue;
+    for (unsigned int begin = 0; begin < count; begin += batchSize)
+    {
+        Job job;
+        job.mFunction = function;
+        job.mData = data;
+        job.mBegin = begin;
+        job.mEnd = begin+batchSize < count ? begin+batchSize : count;
+        job.mRemaining = remaining;
+
+        mQueues[queue]->mMutex.lock();
+        mQueues[queue]->mJobs.push_back(job);
+        mQueues[queue]->mMutex.unlock();
+
+        queue = (queue+1)%mQueues.size();
+    }
+
+    wakeSleepers();
+}
+
+void JobSystem::wait(std::atomic <unsigned int> *remaining)
+{
+    // Help out until every batch is done. Once nothing is left to take, the last batches are running on other
+    // threads, so sleep until one of them finishes the loop or more jobs turn up
+    while (remaining->load() > 0)
+    {
+        Job job;
+        if (popJob(CurrentQueue, job) || stealJob(CurrentQueue, job))
+        {
+            runJob(job);
+            continue;
+        }
+
+        sleep(remaining);
+    }
+}
+
+void JobSystem::workerMain(Worker *worker)
+{
+    JobSystem *jobSystem = worker->mJobSystem;
+    CurrentQueue = worker->mQueue;
+
+    std::ostringstream name;
+    name << "Worker " << worker->mQueue;
+    Tracer::get()->setThreadName(name.str());
+
+    while (true)
+    {
+        Job job;
+        if (jobSystem->popJob(worker->mQueue, job) || jobSystem->stealJob(worker->mQueue, job))
+        {
+            jobSystem->runJob(job);
+            continue;
+        }
+
+        if (!jobSystem->getRunning())
+            return;
+
+        // Nothing to do - sleep until something is dispatched
+        jobSystem->sleep(NULL);
+    }
+}
+
+bool JobSystem::popJob(unsigned int queue, Job &job)
+{
+    sf::Lock lock(mQueues[queue]->mMutex);
+
+    if (mQueues[queue]->mJobs.empty())
+        return false;
+
+    job = mQueues[queue]->mJobs.back();
+    mQueues[queue]->mJobs.pop_back();
+    mQueuedJobs--;
+    return true;
+}
+
+bool JobSystem::stealJob(unsigned int queue, Job &job)
+{
+    for (unsigned int q = 1; q < mQueues.size(); q++)
+    {
+        JobQueue *victim = mQueues[(queue+q)%mQueues.size()];
+        sf::Lock lock(victim->mMutex);
+
+        if (!victim->mJobs.empty())
+        {
+            job = victim->mJobs.front();
+            victim->mJobs.pop_front();
+            mQueuedJobs--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::runJob(Job &job)
+{
+    {
+        TRACE_SCOPE("Job");
+        job.mFunction(job.mData, job.mBegin, job.mEnd);
+    }
+
+    // Whoever is waiting on the loop may be asleep, so the last batch wakes it
+    if (--(*job.mRemaining) == 0)
+        wakeSleepers();
+}
+
+void JobSystem::sleep(std::atomic <unsigned int> *remaining)
+{
+    mWakeMutex.lock();
+    bool idle = mQueuedJobs.load() == 0 && (remaining ? remaining->load() > 0 : mRunning);
+    if (idle)
+        mSleepers.push_back(CurrentQueue);
+    mWakeMutex.unlock();
+
+    // A wakeup that comes between here and the wait is kept by the semaphore, so it isn't lost
+    if (idle)
+        mQueues[CurrentQueue]->mWake.wait();
+}
+
+void JobSystem::wakeSleepers()
+{
+    std::vector <unsigned int> sleepers;
+
+    mWakeMutex.lock();
+    sleepers.swap(mSleepers);
+    mWakeMutex.unlock();
+
+    for (unsigned int s = 0; s < sleepers.size(); s++)
+        mQueues[sleepers[s]]->mWake.post();
+}
+
+bool JobSystem::getRunning()
+{
+    sf::Lock lock(mWakeMutex);
+    return mRunning;
+}
@@ -0,0 +1,195 @@
+/*
+Profiler.cpp
+Theodore DeRego
+Copyright 2012
+
+Profiler implementation
+*/
+
+#include "Core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <SFML/System/Lock.hpp>
+
+#include "Core/Component.h"
+
+static const char *EventNames[ProfileEvent::COUNT] = {"update", "render", "contact"};
+
+Profiler::Profiler()
+{
+    mFrame = 0;
+}
+
+Profiler::~Profiler()
+{
+    //dtor
+}
+
+void Profiler::addSample(Symbol typeName, unsigned int event, float milliseconds)
+{
+    sf::Lock lock(mMutex);
+
+    std::unordered_map <Symbol, TypeHistory, Symbol::Hash>::iterator type = mTypes.find(typeName);
+    if (type == mTypes.end())
+    {
+        TypeHistory history;
+        memset(&history, 0, sizeof(history));
+        type = mTypes.insert(std::make_pair(typeName, history)).first;
+    }
+
+    type->second.mCurrent[event].mTime += milliseconds;
+    type->second.mCurrent[event].mCalls++;
+}
+
+void Profiler::endFrame()
+{
+    sf::Lock lock(mMutex);
+
+    unsigned int slot = mFrame%HistoryLength;
+    for (std::unordered_map <Symbol, TypeHistory, Symbol::Hash>::iterator type = mTypes.begin(); type != mTypes.end(); type++)
+    {
+        for (unsigned int e = 0; e < ProfileEvent::COUNT; e++)
+        {
+            type->second.mFrames[e][slot] = type->second.mCurrent[e];
+            type->second.mCurrent[e].mTime = 0;
+            type->second.mCurrent[e].mCalls = 0;
+        }
+    }
+
+    mFrame++;
+}
+
+bool Profiler::dumpCSV(const std::string &fileName)
+{
+    std::ofstream file(fileName.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to open profile file " << fileName << std::endl;
+        return false;
+    }
+
+    sf::Lock lock(mMutex);
+
+    file << "type,event,frames,calls_per_frame,mean_ms,median_ms,p95_ms,worst_ms\n";
+    for (std::unordered_map <Symbol, TypeHistory, Symbol::Hash>::iterator type = mTypes.begin(); type != mTypes.end(); type++)
+    {
+        for (unsigned int e = 0; e < ProfileEvent::COUNT; e++)
+        {
+            Stats stats = getStats(type->second, e);
+            if (stats.mCalls == 0) // The type never gets this callback
+                continue;
+
+            file << type->first.getString() << "," << EventNames[e] << "," << getFrameCount() << "," << stats.mCalls << ","
+                 << stats.mMean << "," << stats.mMedian << "," << stats.mPercentile95 << "," << stats.mWorst << "\n";
+        }
+    }
+
+    return true;
+}
+
+bool Profiler::dumpJSON(const std::string &fileName)
+{
+    std::ofstream file(fileName.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to open profile file " << fileName << std::endl;
+        return false;
+    }
+
+    sf::Lock lock(mMutex);
+
+    unsigned int frameCount = getFrameCount();
+
+    file << "{\n\t\"frames\": " << frameCount << ",\n\t\"types\": [";
+    bool firstEntry = true;
+    for (std::unordered_map <Symbol, TypeHistory, Symbol::Hash>::iterator type = mTypes.begin(); type != mTypes.end(); type++)
+    {
+        for (unsigned int e = 0; e < ProfileEvent::COUNT; e++)
+        {
+            Stats stats = getStats(type->second, e);
+            if (stats.mCalls == 0)
+                continue;
+
+            file << (firstEntry ? "\n" : ",\n");
+            firstEntry = false;
+
+            file << "\t\t{\"type\": \"" << type->first.getString() << "\", \"event\": \"" << EventNames[e] << "\""
+                 << ", \"calls_per_frame\": " << stats.mCalls << ", \"mean_ms\": " << stats.mMean
+                 << ", \"median_ms\": " << stats.mMedian << ", \"p95_ms\": " << stats.mPercentile95
+                 << ", \"worst_ms\": " << stats.mWorst << ", \"history_ms\": [";
+
+            // Oldest frame first
+            for (unsigned int f = 0; f < frameCount; f++)
+            {
+                unsigned int slot = (mFrame-frameCount+f)%HistoryLength;
+                file << (f > 0 ? ", " : "") << type->second.mFrames[e][slot].mTime;
+            }
+
+            file << "]}";
+        }
+    }
+    file << "\n\t]\n}\n";
+
+    return true;
+}
+
+void Profiler::clear()
+{
+    sf::Lock lock(mMutex);
+
+    mTypes.clear();
+    mFrame = 0;
+}
+
+Profiler *Profiler::get()
+{
+    static Profiler *Instance = new Profiler;
+    return Instance;
+}
+
+Profiler::Stats Profiler::getStats(TypeHistory &history, unsigned int event)
+{
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    unsigned int frameCount = getFrameCount();
+    if (frameCount == 0)
+        return stats;
+
+    std::vector <float> times;
+    for (unsigned int f = 0; f < frameCount; f++)
+    {
+        Frame &frame = history.mFrames[event][f];
+        times.push_back(frame.mTime);
+        stats.mCalls += frame.mCalls;
+        stats.mMean += frame.mTime;
+    }
+
+    stats.mCalls /= frameCount;
+    stats.mMean /= frameCount;
+
+    std::sort(times.begin(), times.end());
+    stats.mMedian = times[frameCount/2];
+    stats.mPercentile95 = times[(frameCount*95)/100];
+    stats.mWorst = times.back();
+
+    return stats;
+}
+
+Profiler::Sample::Sample(Component *component, unsigned int event)
+{
+    mTypeName = component->getTypeName();
+    mEvent = event;
+    mStart = std::chrono::high_resolution_clock::now();
+}
+
+Profiler::Sample::~Sample()
+{
+    std::chrono::duration <float, std::milli> time = std::chrono::high_resolution_clock::now()-mStart;
+    Profiler::get()->addSample(mTypeName, mEvent, time.count());
+}
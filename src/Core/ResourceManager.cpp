@@ -1,10 +1,15 @@
 #include "Core/ResourceManager.h"
 
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Lock.hpp>
+
 ResourceManager *ResourceManager::Instance = NULL;
 
 ResourceManager::ResourceManager()
 {
     Instance = this;
+
+    mHeadless = false;
 }
 
 ResourceManager::~ResourceManager()
@@ -14,6 +19,14 @@ ResourceManager::~ResourceManager()
 
 sf::Texture *ResourceManager::getTexture(std::string name)
 {
+    #ifdef FISSION_HEADLESS
+    return NULL;
+    #else
+    if (mHeadless)
+        return NULL;
+
+    sf::Lock lock(mMutex);
+
     sf::Texture *texture = NULL;
     Resource *resource = findResource(name);
 
@@ -36,10 +49,16 @@ sf::Texture *ResourceManager::getTexture(std::string name)
     }
 
     return texture;
+    #endif
 }
 
 sf::Font *ResourceManager::getFont(std::string name)
 {
+    #ifdef FISSION_HEADLESS
+    return NULL;
+    #else
+    sf::Lock lock(mMutex);
+
     sf::Font *font = NULL;
     Resource *resource = findResource(name);
 
@@ -61,6 +80,32 @@ sf::Font *ResourceManager::getFont(std::string name)
     }
 
     return font;
+    #endif
+}
+
+sf::Vector2u ResourceManager::getImageSize(std::string name)
+{
+    #ifndef FISSION_HEADLESS
+    if (!mHeadless)
+        return getTexture(name)->getSize();
+    #endif
+
+    sf::Lock lock(mMutex);
+
+    for (unsigned int r = 0; r < mImageSizes.size(); r++)
+        if (mImageSizes[r].mName == name)
+            return *(sf::Vector2u*)mImageSizes[r].mData;
+
+    // Loading an image only decodes it into memory, so it works without a GL context
+    sf::Image image;
+    image.loadFromFile(name);
+
+    Resource rc;
+    rc.mName = name;
+    rc.mData = new sf::Vector2u(image.getSize());
+    mImageSizes.push_back(rc);
+
+    return image.getSize();
 }
 
 Resource *ResourceManager::findResource(std::string name)
@@ -0,0 +1,69 @@
+/*
+Semaphore.cpp
+Theodore DeRego
+Copyright 2012
+
+Semaphore implementation
+*/
+
+#include "Core/Semaphore.h"
+
+#ifdef _WIN32
+    #include <climits>
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <semaphore.h>
+#endif
+
+#ifdef _WIN32
+
+Semaphore::Semaphore()
+{
+    mSemaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+}
+
+Semaphore::~Semaphore()
+{
+    CloseHandle((HANDLE)mSemaphore);
+}
+
+void Semaphore::wait()
+{
+    WaitForSingleObject((HANDLE)mSemaphore, INFINITE);
+}
+
+void Semaphore::post(unsigned int count)
+{
+    if (count > 0)
+        ReleaseSemaphore((HANDLE)mSemaphore, count, NULL);
+}
+
+#else
+
+Semaphore::Semaphore()
+{
+    sem_t *semaphore = new sem_t;
+    sem_init(semaphore, 0, 0);
+    mSemaphore = semaphore;
+}
+
+Semaphore::~Semaphore()
+{
+    sem_destroy((sem_t*)mSemaphore);
+    delete (sem_t*)mSemaphore;
+}
+
+void Semaphore::wait()
+{
+    while (sem_wait((sem_t*)mSemaphore) != 0 && errno == EINTR) // Signals interrupt the wait without posting
+        ;
+}
+
+void Semaphore::post(unsigned int count)
+{
+    for (unsigned int c = 0; c < count; c++)
+        sem_post((sem_t*)mSemaphore);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+Symbol.cpp
+Theodore DeRego
+Copyright 2012
+
+Symbol implementation
+*/
+
+#include "Core/Symbol.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Mutex.hpp>
+
+/// Every interned string by ID. Symbols can be made from worker threads, so the table is guarded
+struct SymbolTable
+{
+    std::unordered_map <unsigned int, std::string> mStrings;
+    sf::Mutex mMutex;
+};
+
+/// Never freed, so symbols stay valid while statics are destroyed
+static SymbolTable *getSymbolTable()
+{
+    static SymbolTable *Table = new SymbolTable;
+    return Table;
+}
+
+Symbol::Symbol(const char *string)
+{
+    intern(string);
+}
+
+Symbol::Symbol(const std::string &string)
+{
+    intern(string.c_str());
+}
+
+unsigned int Symbol::hash(const char *string)
+{
+    if (string[0] == '\0')
+        return 0;
+
+    // 32 bit FNV-1a
+    unsigned int hash = 2166136261u;
+    for (const char *c = string; *c != '\0'; c++)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 16777619u;
+    }
+
+    return hash != 0 ? hash : 1; // 0 is saved for the empty string
+}
+
+void Symbol::intern(const char *string)
+{
+    mID = hash(string);
+    if (mID == 0)
+        return;
+
+    SymbolTable *table = getSymbolTable();
+    sf::Lock lock(table->mMutex);
+
+    std::unordered_map <unsigned int, std::string>::iterator interned = table->mStrings.find(mID);
+    if (interned == table->mStrings.end())
+        table->mStrings.insert(std::make_pair(mID, std::string(string)));
+    else if (interned->second != string)
+    {
+        // The two would compare equal here and on the wire. Names are fixed when the game is built, so rename one
+        std::cout << "Symbols \"" << interned->second << "\" and \"" << string << "\" have the same hash\n";
+        std::abort();
+    }
+}
+
+const std::string &Symbol::getString() const
+{
+    static const std::string Empty;
+    if (mID == 0)
+        return Empty;
+
+    SymbolTable *table = getSymbolTable();
+    sf::Lock lock(table->mMutex);
+
+    std::unordered_map <unsigned int, std::string>::iterator interned = table->mStrings.find(mID);
+    return interned != table->mStrings.end() ? interned->second : Empty;
+}
@@ -0,0 +1,155 @@
+/*
+Tracer.cpp
+Theodore DeRego
+Copyright 2012
+
+Tracer implementation
+*/
+
+#include "Core/Tracer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <SFML/System/Lock.hpp>
+
+Tracer *Tracer::Instance = new Tracer;
+thread_local Tracer::ThreadBuffer *Tracer::CurrentBuffer = NULL;
+
+Tracer::Tracer()
+{
+    mCapturing = false;
+    mCapture = 0;
+    mEpoch = getClock();
+}
+
+Tracer::~Tracer()
+{
+    for (unsigned int b = 0; b < mBuffers.size(); b++)
+        delete mBuffers[b];
+}
+
+void Tracer::start()
+{
+    if (getCapturing())
+        return;
+
+    // Threads may be recording right now, so their buffers are left for them to reset when they next record
+    mEpoch.store(getClock(), std::memory_order_relaxed);
+    mCapture.fetch_add(1, std::memory_order_release);
+    mCapturing.store(true, std::memory_order_release);
+
+    std::cout << "Started trace capture" << std::endl;
+}
+
+void Tracer::stop()
+{
+    if (!getCapturing())
+        return;
+
+    mCapturing.store(false, std::memory_order_release);
+
+    std::cout << "Stopped trace capture" << std::endl;
+}
+
+bool Tracer::write(const std::string &fileName)
+{
+    std::ofstream file(fileName.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to open trace file " << fileName << std::endl;
+        return false;
+    }
+
+    sf::Lock lock(mBuffersMutex);
+
+    file << "{\"traceEvents\":[\n";
+
+    unsigned int capture = getCapture();
+    bool firstEvent = true;
+    char line[256];
+    for (unsigned int b = 0; b < mBuffers.size(); b++)
+    {
+        ThreadBuffer *buffer = mBuffers[b];
+
+        if (!buffer->mName.empty())
+        {
+            file << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->mThreadID
+                 << ",\"args\":{\"name\":\"" << buffer->mName << "\"}}";
+            firstEvent = false;
+        }
+
+        // Oldest event first. Only the last BufferSize events are still there, and none if the thread hasn't
+        // recorded anything since the capture started
+        if (buffer->mCapture.load(std::memory_order_acquire) != capture)
+            continue;
+
+        unsigned int written = buffer->mWritten.load(std::memory_order_acquire);
+        unsigned int first = written > BufferSize ? written-BufferSize : 0;
+        for (unsigned int e = first; e < written; e++)
+        {
+            Event &event = buffer->mEvents[e%BufferSize];
+
+            // Chrome wants microseconds
+            snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                     event.mName, event.mStart/1000.0, event.mDuration/1000.0, buffer->mThreadID);
+
+            file << (firstEvent ? "" : ",\n") << line;
+            firstEvent = false;
+        }
+    }
+
+    file << "\n]}\n";
+
+    return true;
+}
+
+void Tracer::setThreadName(const std::string &name)
+{
+    ThreadBuffer *buffer = getThreadBuffer();
+
+    sf::Lock lock(mBuffersMutex);
+    buffer->mName = name;
+}
+
+void Tracer::record(const char *name, unsigned int capture, long long start, long long duration)
+{
+    unsigned int current = getCapture();
+    if (capture != current) // Started before this capture, so its time is against the old epoch
+        return;
+
+    ThreadBuffer *buffer = getThreadBuffer();
+    if (buffer->mCapture.load(std::memory_order_relaxed) != current) // First event of the capture on this thread
+    {
+        buffer->mWritten.store(0, std::memory_order_relaxed);
+        buffer->mCapture.store(current, std::memory_order_release);
+    }
+
+    unsigned int written = buffer->mWritten.load(std::memory_order_relaxed);
+
+    Event &event = buffer->mEvents[written%BufferSize];
+    event.mName = name;
+    event.mStart = start;
+    event.mDuration = duration;
+
+    // Publish the event only once it's filled in
+    buffer->mWritten.store(written+1, std::memory_order_release);
+}
+
+Tracer::ThreadBuffer *Tracer::getThreadBuffer()
+{
+    if (CurrentBuffer)
+        return CurrentBuffer;
+
+    ThreadBuffer *buffer = new ThreadBuffer;
+    buffer->mCapture = 0;
+    buffer->mWritten = 0;
+
+    sf::Lock lock(mBuffersMutex);
+    buffer->mThreadID = mBuffers.size()+1;
+    mBuffers.push_back(buffer);
+
+    CurrentBuffer = buffer;
+    return buffer;
+}
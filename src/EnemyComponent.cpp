@@ -26,6 +26,8 @@ enum
 
 EnemyComponent::EnemyComponent(GameObject *object, std::string name, GameState *state) : Component(object, name)
 {
+    mTypeName = "EnemyComponent";
+
     mGameState = state;
 
     mOnGround = false; // Floating by default
@@ -35,7 +37,13 @@ EnemyComponent::EnemyComponent(GameObject *object, std::string name, GameState *
     mMoveState = STAND;
     mDirection = LEFT;
 
-    mLeader = NULL;
+    mLeader = Handle();
+
+    // Deciding where to go doesn't need doing every tick. The body keeps its velocity in between
+    setUpdateRate(5.f);
+
+    subscribe(ComponentCallback::CONTACT_BEGIN);
+    subscribe(ComponentCallback::CONTACT_END);
 }
 
 EnemyComponent::~EnemyComponent()
@@ -65,9 +73,10 @@ bool EnemyComponent::update(float dt)
     bool left, right, jump;
     left = right = jump = false;
 
-    if (mLeader)
+    GameObject *leader = GameObject::get(mLeader); // My leader may have been destroyed
+    if (leader)
     {
-        float xdist = mLeader->getPosition().x-mGameObject->getPosition().x; // Distance from my leader
+        float xdist = leader->getPosition().x-mGameObject->getPosition().x; // Distance from my leader
 
         if (xdist < -mFollowDistance)
             left = true;
@@ -233,9 +242,9 @@ void EnemyComponent::onContactBegin(GameObject *object)
                 object->onContactEnd(mGameObject);
 
                 // Following stuff
-                mLeader = object;
-                mFollowDistance = 4.f+(mLeader->getComponent<PlayerControlComponent>()->getFollowers()*1.f);
-                mLeader->getComponent<PlayerControlComponent>()->addFollower();
+                mLeader = object->getHandle();
+                mFollowDistance = 4.f+(object->getComponent<PlayerControlComponent>()->getFollowers()*1.f);
+                object->getComponent<PlayerControlComponent>()->addFollower();
 
                 // Turn me into a loving peewee - they don't collide with the leader and look prettier
                 mGameObject->getComponent<RigidBodyComponent>()->setCollisionGroup(1);
@@ -1,27 +1,43 @@
 #include "Game.h"
 
 #include <Core/Math.h>
+#include <Core/FramePacer.h>
+#include <Core/JobSystem.h>
+#include <Core/Profiler.h>
 #include <Core/ResourceManager.h>
 #include <Core/InputManager.h>
 #include <Core/StateManager.h>
+#include <Core/Tracer.h>
 #include <Rendering/RenderingManager.h>
 #include <Physics/PhysicsManager.h>
 #include <Scene/SceneManager.h>
 #include <Network/NetworkManager.h>
 
-Game::Game()
+Game::Game(bool headless)
 {
     mRunning = true;
+    mHeadless = headless;
+    #ifdef FISSION_HEADLESS
+    mHeadless = true; // Built without windows or GL, so it can't be anything else
+    #endif
 
     mResourceManager = new ResourceManager;
+    mResourceManager->setHeadless(mHeadless);
     mStateManager = new StateManager;
-    mSceneManager = new SceneManager;
-    mRenderingManager = new RenderingManager;
     mPhysicsManager = new PhysicsManager;
+    mSceneManager = new SceneManager;
+    mRenderingManager = new RenderingManager(mHeadless);
+    mSceneManager->getMainScene()->setLightSystem(mRenderingManager->getLightSystem()); // The main scene is the one drawn
     mInputManager = new InputManager(mRenderingManager->getRenderWindow());
     mNetworkManager = new NetworkManager;
+    mJobSystem = new JobSystem;
+    mFramePacer = new FramePacer;
+    mFramePacer->setRendering(!mHeadless);
 
     mLockStep = 1.f/30.f;
+
+    mTracePresses = 0;
+    mBudgetReportPresses = 0;
 }
 
 Game::~Game()
@@ -33,60 +49,125 @@ void Game::run(State *state)
 {
     mStateManager->pushState(state);
 
-    int lastFrameTime = InputManager::get()->getTime();
-    float deltaTime = 0;
+    Tracer::get()->setThreadName("Main");
+
+    mFramePacer->setTickRate(1.f/mLockStep);
+    mFramePacer->reset();
 
     while (mRunning)
     {
-        while (InputManager::get()->getTime()-lastFrameTime < 1); // Cap framerate at 1000 FPS
+        TRACE_SCOPE("Frame");
 
-        deltaTime = (InputManager::get()->getTime()-lastFrameTime)/1000.f;
-        lastFrameTime = InputManager::get()->getTime();
+        // Sleep until the next tick, network update or render is due
+        {
+            TRACE_SCOPE("FramePacer::beginFrame");
+            mFramePacer->beginFrame();
+        }
 
         //calculate framerate
-        mFrameRate = 1.f/deltaTime;
-
-        // Calculate fixed time step accumulator stuff
-        mLockStepAccumulator += deltaTime; //add the frame time to the accumulator
-        int physicsSteps = floorf(mLockStepAccumulator / mLockStep); //calculate physics steps needed this frame
-
-        if (physicsSteps > 0) //insure that there are no rounding errors
-            mLockStepAccumulator -= physicsSteps * mLockStep;
+        mFrameRate = 1.f/mFramePacer->getFrameTime();
 
-        mLockStepAccumulatorRatio = mLockStepAccumulator / mLockStep;
-
-        for (int s = 0; s < physicsSteps; s++)
+        for (unsigned int s = 0; s < mFramePacer->getTickCount(); s++)
         {
             float timeStep = mLockStep;
 
+            TRACE_SCOPE("Tick");
+
             // Update the managers
             if (mRunning && !mPhysicsManager->getPaused())
+            {
+                TRACE_SCOPE("PhysicsManager::update");
                 mRunning = mPhysicsManager->update(timeStep);
+            }
             if (mRunning && !mInputManager->getPaused())
+            {
+                TRACE_SCOPE("InputManager::update");
                 mRunning = mInputManager->update(timeStep);
+            }
             if (mRunning && !mSceneManager->getPaused())
+            {
+                TRACE_SCOPE("SceneManager::update");
                 mRunning = mSceneManager->update(timeStep);
+            }
             if (mRunning && !mStateManager->getPaused())
+            {
+                TRACE_SCOPE("StateManager::update");
                 mRunning = mStateManager->update(timeStep);
+            }
             if (mRunning && !mRenderingManager->getPaused())
+            {
+                TRACE_SCOPE("RenderingManager::update");
                 mRunning = mRenderingManager->update(timeStep);
+            }
+        }
+
+        // F9 starts a trace capture, and pressing it again writes the capture to trace.json. Checked once a frame,
+        // whether the press came in on one of this frame's ticks or an earlier frame's
+        unsigned int tracePresses = mInputManager->getKeyPressCount(sf::Keyboard::F9);
+        if (tracePresses != mTracePresses)
+        {
+            mTracePresses = tracePresses;
+
+            if (Tracer::get()->getCapturing())
+            {
+                Tracer::get()->stop();
+                Tracer::get()->write("trace.json");
+            }
+            else
+                Tracer::get()->start();
+        }
+
+        #ifdef FISSION_DEBUG
+        // F10 turns printing the main scene's update budgets once a second on and off
+        unsigned int budgetReportPresses = mInputManager->getKeyPressCount(sf::Keyboard::F10);
+        if (budgetReportPresses != mBudgetReportPresses)
+        {
+            mBudgetReportPresses = budgetReportPresses;
+
+            Scene *scene = mSceneManager->getMainScene();
+            scene->setBudgetReportInterval(scene->getBudgetReportInterval() > 0 ? 0 : (unsigned int)(1.f/mLockStep+0.5f));
         }
+        #endif
+
+        mLockStepAccumulatorRatio = mFramePacer->getTickRatio();
 
         // Update network manager disregarding lockstep
-        if (mRunning && !mNetworkManager->getPaused())
-            mRunning = mNetworkManager->update(deltaTime);
+        if (mRunning && mFramePacer->getNetworkDue() && !mNetworkManager->getPaused())
+        {
+            TRACE_SCOPE("NetworkManager::update");
+            mRunning = mNetworkManager->update(mFramePacer->getNetworkTime());
+        }
+
+        if (!mFramePacer->getRenderDue())
+        {
+            PROFILE_END_FRAME(); // Still a frame. A headless server never renders, so this is the only place it ends
+            continue;
+        }
+
+        TRACE_SCOPE("Render");
+
+        // Draw everything between where it was after the last two ticks, so motion is smooth at any frame rate
+        mRenderingManager->setInterpolation(mLockStepAccumulatorRatio);
 
         //start rendering
         mRenderingManager->beginRender();
 
         mStateManager->getCurrentState()->onPreRender(mRenderingManager->getRenderWindow());
-        mSceneManager->getCurrentScene()->onRender(mRenderingManager->getRenderWindow());
+        {
+            TRACE_SCOPE("Scene::onRender");
+            mSceneManager->getCurrentScene()->onRender(mRenderingManager->getRenderWindow());
+        }
 
         mRenderingManager->renderLights();
 
         mStateManager->getCurrentState()->onPostRender(mRenderingManager->getRenderWindow());
 
         //finish rendering
-        mRenderingManager->endRender();
+        {
+            TRACE_SCOPE("RenderingManager::endRender");
+            mRenderingManager->endRender();
+        }
+
+        PROFILE_END_FRAME();
     }
 }
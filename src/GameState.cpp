@@ -9,6 +9,9 @@
 #include <string>
 
 #include <Fission.h>
+#ifndef FISSION_HEADLESS
+#include <LTBL/Light/LightSystem.h>
+#endif
 
 #include "HeroControlComponent.h"
 
@@ -28,23 +31,34 @@ GameState::GameState(Game *game, int netType)
     mPlanetGenerator = new PlanetGenerator;
 
     mHero = NULL;
+
+    mRobotPrefab = NULL;
 }
 
 GameState::~GameState()
 {
-    //dtor
+    delete mRobotPrefab;
 }
 
 void GameState::initialize()
 {
-    SceneManager::get()->registerComponentCreationFunction("HeroControlComponent", HeroControlComponent::createComponent);
+    SceneManager::get()->registerComponentType<HeroControlComponent>("HeroControlComponent");
 
     RenderingManager::get()->setCameraPosition(sf::Vector2f(0.f,38.f));
 
+    // The game is played in the main scene, which connectors join
+    Scene *scene = SceneManager::get()->getMainScene();
+
     // Ambient light
-    RenderingManager::get()->getLightSystem()->m_ambientColor = sf::Color(255,255,255);
+    #ifndef FISSION_HEADLESS
+    if (scene->getLightSystem())
+        scene->getLightSystem()->m_ambientColor = sf::Color(255,255,255);
+    #endif
 
-    PhysicsManager::get()->getWorld()->SetGravity(b2Vec2(0.f,-9.f));
+    scene->getWorld()->SetGravity(b2Vec2(0.f,-9.f));
+
+    // Animation is the first thing to give up when there are too many sprites to fit in 2ms a tick
+    scene->getUpdateScheduler()->setBudget("SpriteComponent", 2.f);
 
     if (mNetworkType == NetworkType::SERVER)
         NetworkManager::get()->hostServer(50000);
@@ -59,7 +73,7 @@ void GameState::initialize()
         //GameObject *planet = mPlanetGenerator->generatePlanet();
         //SceneManager::get()->saveGameObject(planet, "planet.fobj");
 
-        PhysicsManager::get()->setGroundBody(planet->getComponent<RigidBodyComponent>()->getBody());
+        scene->setGroundBody(planet->getComponent<RigidBodyComponent>()->getBody());
     }
 
     RenderingManager::get()->setCameraPosition(sf::Vector2f(0.f, 65.f));
@@ -83,15 +97,26 @@ void GameState::onPostRender(sf::RenderTarget *target, sf::RenderStates states)
 
 void GameState::onConnect(int ID)
 {
-    GameObject *player;
-    player = SceneManager::get()->createGameObject();
-    player->addComponent(new SpriteComponent(player, "sprite", "Content/Textures/robot.png", 1, 1));
-    player->addComponent(new RigidBodyComponent(player, "body", ""));
+    // The robot goes in the connector's room
+    Scene *scene = NetworkManager::get()->findConnector(ID).mScene;
+
+    if (!mRobotPrefab) // Build the template on the first connection
+    {
+        GameObject *robot = GameObject::create();
+        robot->setScene(scene); // Only for its pooled components. It never joins the scene
+        robot->addPooledComponent<SpriteComponent>("sprite", "Content/Textures/robot.png", 1, 1);
+        robot->addPooledComponent<RigidBodyComponent>("body", "");
+        robot->getComponent<SpriteComponent>()->setAnimDelay(100);
+        robot->getComponent<RigidBodyComponent>()->getBody()->SetFixedRotation(true);
+        robot->getComponent<RigidBodyComponent>()->setCollisionGroup(1);
+
+        mRobotPrefab = new Prefab(robot);
+        robot->release();
+    }
+
+    GameObject *player = mRobotPrefab->instantiate(scene, sf::Vector2f(0,70.f));
     player->addComponent(new HeroControlComponent(player, "control", ID));
-    player->setPosition(sf::Vector2f(0,70.f));
-    player->getComponent<SpriteComponent>()->setAnimDelay(100);
-    player->getComponent<RigidBodyComponent>()->getBody()->SetFixedRotation(true);
-    player->getComponent<RigidBodyComponent>()->setCollisionGroup(1);
+    NetworkManager::get()->setConnectorFocus(ID, player); // Scene updates only cover what's around the player
 
     NetworkManager::get()->sendSceneCreation(ID); // Send the scene to the new connector
     NetworkManager::get()->sendGameObject(player, 0, ID); // Send the player to everyone except the connector
@@ -125,8 +150,9 @@ void GameState::handlePacket(sf::Packet &packet, int connectorID)
                 int playerID;
                 packet >> playerID;
                 Player *player = mPlayerDatabase->findPlayer(playerID);
-                if (playerID == connectorID && player) // Extra security
-                    (player->mGameObject->getComponent<HeroControlComponent>("control"))->handlePacket(packet);
+                GameObject *object = player ? GameObject::get(player->mGameObject) : NULL;
+                if (playerID == connectorID && object) // Extra security
+                    (object->getComponent<HeroControlComponent>("control"))->handlePacket(packet);
 
                 break;
             }
@@ -158,7 +184,7 @@ void GameState::handlePacket(sf::Packet &packet, int connectorID)
                 int objID, playerID;
                 packet >> playerID;
                 packet >> objID;
-                SceneManager::get()->findGameObject(objID);
+                SceneManager::get()->getMainScene()->findGameObject(objID); // Clients only have the one scene
 
                 break;
             }
@@ -168,8 +194,9 @@ void GameState::handlePacket(sf::Packet &packet, int connectorID)
                 int playerID;
                 packet >> playerID;
                 Player *player = mPlayerDatabase->findPlayer(playerID);
-                if (player)
-                    (player->mGameObject->getComponent<HeroControlComponent>("control"))->handlePacket(packet);
+                GameObject *object = player ? GameObject::get(player->mGameObject) : NULL;
+                if (object)
+                    (object->getComponent<HeroControlComponent>("control"))->handlePacket(packet);
 
                 break;
             }
@@ -21,20 +21,35 @@ HeroControlComponent::HeroControlComponent(GameObject *object, std::string name,
     mSpriteComponent = mGameObject->getComponent<SpriteComponent>();
     mBodyComponent = mGameObject->getComponent<RigidBodyComponent>();
 
-    // Add the arms
-    mLeftArm = (SpriteComponent*)mGameObject->addComponent(new SpriteComponent(mGameObject, "left", "Content/Textures/left.png", 1, 1));
-    mRightArm = (SpriteComponent*)mGameObject->addComponent(new SpriteComponent(mGameObject, "right", "Content/Textures/right.png", 1, 1));
-    mLeftArm->setShouldSerialize(false);
-    mRightArm->setShouldSerialize(false);
+    // Add the arms. Every client makes its own when the hero arrives, so they aren't synced
+    mLeftArm = createArm("Content/Textures/left.png", sf::Vector2f(-1.f, 0));
+    mRightArm = createArm("Content/Textures/right.png", sf::Vector2f(1.f, 0));
 
     mGameObject->setSyncNetwork(true); // Sync over the network
+    mGameObject->setActivityAnchor(true); // Keep the world around players awake
 
     mTypeName = "HeroControlComponent";
 }
 
 HeroControlComponent::~HeroControlComponent()
 {
-    //dtor
+    // The arms go with the controls. They're gone already if the hero died, since children die with their parent
+    GameObject *leftArm = GameObject::get(mLeftArm);
+    if (leftArm)
+        leftArm->kill();
+    GameObject *rightArm = GameObject::get(mRightArm);
+    if (rightArm)
+        rightArm->kill();
+}
+
+Handle HeroControlComponent::createArm(std::string texture, sf::Vector2f position)
+{
+    GameObject *arm = SceneManager::get()->createGameObject(mGameObject->getScene());
+    arm->addPooledComponent<SpriteComponent>("sprite", texture, 1, 1);
+    arm->setPosition(position); // Relative to the hero, so this is only done once
+
+    mGameObject->addChild(arm);
+    return arm->getHandle();
 }
 
 void HeroControlComponent::serialize(sf::Packet &packet)
@@ -88,10 +103,6 @@ bool HeroControlComponent::update(float dt)
 
     processInput();
 
-    // Move the arms for pretty arm visuals
-    mLeftArm->setPosition(sf::Vector2f(-1.f, 0));
-    mRightArm->setPosition(sf::Vector2f(1.f, 0));
-
     return true;
 }
 
@@ -147,18 +158,6 @@ void HeroControlComponent::handlePacket(sf::Packet &packet)
     }
 }
 
-void HeroControlComponent::onPreSolve(GameObject *object, b2Contact* contact, const b2Manifold* oldManifold)
-{
-}
-
-void HeroControlComponent::onContactBegin(GameObject *object)
-{
-}
-
-void HeroControlComponent::onContactEnd(GameObject *object)
-{
-}
-
 Component *HeroControlComponent::createComponent(GameObject *object)
 {
     return new HeroControlComponent(object, "control", -1);
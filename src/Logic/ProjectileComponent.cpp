@@ -1,20 +1,31 @@
 #include "Logic/ProjectileComponent.h"
 
-#include <GL/gl.h>
+#ifndef FISSION_HEADLESS
+#include <LTBL/Light/EmissiveLight.h>
+#include <LTBL/Light/LightSystem.h>
+#endif
 #include <Core/ResourceManager.h>
 #include <Core/GameObject.h>
 #include <Rendering/RenderingManager.h>
+#include <Scene/Scene.h>
 
 #include <iostream>
 
 ProjectileComponent::ProjectileComponent(GameObject *object, std::string name, int dmg, float range, bool visual) : Component(object, name)
 {
+    mTypeName = "ProjectileComponent";
+
     mDamage = dmg;
     mDistanceLeft = range;
     mVisual = visual;
-
-    // Create an emissive light
-    if (mVisual)
+    mParallelSafe = true; // Projectiles only move and kill their own GameObject
+    mGameObject->setAlwaysActive(true); // Nothing else moves it, so it would never wake up
+
+    // Create an emissive light, unless there's no light system to add it to
+    mLightSystem = mGameObject->getScene() ? mGameObject->getScene()->getLightSystem() : NULL;
+    mEmissiveLight = NULL;
+    #ifndef FISSION_HEADLESS
+    if (mVisual && mLightSystem)
     {
         mEmissiveLight = new ltbl::EmissiveLight();
 
@@ -22,16 +33,17 @@ ProjectileComponent::ProjectileComponent(GameObject *object, std::string name, i
 
         mEmissiveLight->m_intensity = 1.1f;
 
-        RenderingManager::get()->getLightSystem()->AddEmissiveLight(mEmissiveLight);
+        mLightSystem->AddEmissiveLight(mEmissiveLight);
     }
-    else
-        mEmissiveLight = NULL;
+    #endif
 }
 
 ProjectileComponent::~ProjectileComponent()
 {
+    #ifndef FISSION_HEADLESS
     if (mEmissiveLight)
-        RenderingManager::get()->getLightSystem()->RemoveEmissiveLight(mEmissiveLight);
+        mLightSystem->RemoveEmissiveLight(mEmissiveLight);
+    #endif
 }
 
 bool ProjectileComponent::update(float dt)
@@ -52,16 +64,20 @@ bool ProjectileComponent::update(float dt)
 void ProjectileComponent::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
     // Update the emissive light's position
+    #ifndef FISSION_HEADLESS
     if (mEmissiveLight)
     {
         sf::Vector2u screenSize = target->getSize();
 
-        sf::Vector2f newPos = mGameObject->getPosition()*RenderingManager::get()->getPTU();
+        // Where the sprite is drawn, between the last two ticks
+        float alpha = RenderingManager::get()->getInterpolation();
+        sf::Vector2f newPos = mGameObject->getRenderPosition(alpha)*RenderingManager::get()->getPTU();
         newPos.y *= -1;
 
         Vec2f lightPos = Vec2f(newPos.x, newPos.y);
 
         mEmissiveLight->SetCenter(Vec2f(lightPos.x, screenSize.y-lightPos.y));
-        mEmissiveLight->SetRotation(mGameObject->getRotation());
+        mEmissiveLight->SetRotation(mGameObject->getRenderRotation(alpha));
     }
+    #endif
 }
@@ -3,7 +3,6 @@
 #include <Core/Math.h>
 #include <Core/GameObject.h>
 #include <Scene/SceneManager.h>
-#include <Physics/PhysicsManager.h>
 #include <Logic/ProjectileComponent.h>
 
 //subclass b2QueryCallback
@@ -76,7 +75,7 @@ void WeaponComponent::fire(float rotation)
             GameObject *hitObject = NULL; //the object we hit
             float closestFraction = 1; //start with end of line as p2
             sf::Vector2f normal; //the normal vector of this intersection
-            for (b2Body* b = PhysicsManager::get()->getWorld()->GetBodyList(); b; b = b->GetNext())
+            for (b2Body* b = mGameObject->getScene()->getWorld()->GetBodyList(); b; b = b->GetNext())
             {
                 if (!b->IsActive() || ((GameObject*)b->GetUserData()) == mGameObject) //skip inactive objects and this weapon's object
                     continue;
@@ -97,10 +96,9 @@ void WeaponComponent::fire(float rotation)
             sf::Vector2f intersectionPoint = start + (closestFraction * (end - start));
 
             // Create the projectile
-            GameObject *proj = SceneManager::get()->createGameObject();
+            GameObject *proj = SceneManager::get()->createGameObject(mGameObject->getScene());
 
-            ProjectileComponent *pcomp = new ProjectileComponent(proj, "projectile", mDamage, closestFraction*mRange, mVisibleBullets);
-            proj->addComponent(pcomp);
+            proj->addPooledComponent<ProjectileComponent>("projectile", mDamage, closestFraction*mRange, mVisibleBullets);
 
             proj->setPosition(start);
             proj->setRotation(rotation);
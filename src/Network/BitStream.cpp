@@ -0,0 +1,168 @@
+/*
+BitStream.cpp
+Theodore DeRego
+Copyright 2012
+
+BitStream implementation
+*/
+
+#include "Network/BitStream.h"
+
+#include <cmath>
+
+/// The largest step a quantization with this many bits has
+static sf::Uint32 getMaxStep(unsigned int bits)
+{
+    return (sf::Uint32)((1ULL << bits)-1);
+}
+
+Quantization Quantization::fromResolution(float min, float max, float resolution)
+{
+    double steps = std::ceil((max-min)/resolution);
+
+    unsigned int bits = 1;
+    while (bits < 32 && (double)getMaxStep(bits) < steps)
+        bits++;
+
+    return Quantization(min, max, bits);
+}
+
+sf::Uint32 Quantization::encode(float value) const
+{
+    double range = (double)mMax-mMin;
+
+    if (mWrap)
+    {
+        double steps = (double)(1ULL << mBits);
+        double turn = std::fmod(((double)value-mMin)/range, 1.0);
+        if (turn < 0)
+            turn += 1.0;
+        else if (!(turn >= 0)) // NaN
+            turn = 0;
+
+        return (sf::Uint32)((sf::Uint64)(turn*steps+0.5) & getMaxStep(mBits)); // Rounding up to a whole turn is 0
+    }
+
+    if (!(value > mMin)) // NaN too
+        return 0;
+    if (value >= mMax)
+        return getMaxStep(mBits);
+
+    return (sf::Uint32)(((double)value-mMin)/range*getMaxStep(mBits)+0.5);
+}
+
+float Quantization::decode(sf::Uint32 step) const
+{
+    double range = (double)mMax-mMin;
+
+    if (mWrap)
+        return (float)(mMin+range*step/(double)(1ULL << mBits));
+
+    return (float)(mMin+range*step/getMaxStep(mBits));
+}
+
+BitWriter::BitWriter()
+{
+    mScratch = 0;
+    mScratchBits = 0;
+    mBitCount = 0;
+}
+
+BitWriter::~BitWriter()
+{
+    //dtor
+}
+
+void BitWriter::write(sf::Uint32 value, unsigned int bits)
+{
+    if (bits < 32)
+        value &= getMaxStep(bits);
+
+    mScratch |= (sf::Uint64)value << mScratchBits;
+    mScratchBits += bits;
+    mBitCount += bits;
+
+    while (mScratchBits >= 8)
+    {
+        mData.push_back((sf::Uint8)mScratch);
+        mScratch >>= 8;
+        mScratchBits -= 8;
+    }
+}
+
+void BitWriter::writeVariable(sf::Uint32 value)
+{
+    // Each group of seven bits is followed by whether there's another one
+    do
+    {
+        write(value & 0x7F, 7);
+        value >>= 7;
+        write(value != 0, 1);
+    }
+    while (value != 0);
+}
+
+void BitWriter::flush(sf::Packet &packet)
+{
+    if (mScratchBits > 0)
+    {
+        mData.push_back((sf::Uint8)mScratch);
+        mScratch = 0;
+        mScratchBits = 0;
+    }
+
+    // Laid out like an sf::Packet string, so the reader can take it out in one go
+    packet << sf::Uint32(mData.size());
+    if (!mData.empty())
+        packet.append(&mData[0], mData.size());
+
+    mData.clear();
+}
+
+BitReader::BitReader(sf::Packet &packet)
+{
+    mReadPosition = 0;
+    mScratch = 0;
+    mScratchBits = 0;
+    mValid = packet >> mData;
+}
+
+BitReader::~BitReader()
+{
+    //dtor
+}
+
+sf::Uint32 BitReader::read(unsigned int bits)
+{
+    while (mScratchBits < bits)
+    {
+        if (!mValid || mReadPosition >= mData.size())
+        {
+            mValid = false;
+            return 0;
+        }
+
+        mScratch |= (sf::Uint64)(sf::Uint8)mData[mReadPosition++] << mScratchBits;
+        mScratchBits += 8;
+    }
+
+    sf::Uint32 value = (sf::Uint32)(mScratch & getMaxStep(bits));
+    mScratch >>= bits;
+    mScratchBits -= bits;
+
+    return value;
+}
+
+sf::Uint32 BitReader::readVariable()
+{
+    sf::Uint32 value = 0;
+    for (unsigned int shift = 0; shift < 32; shift += 7)
+    {
+        value |= read(7) << shift;
+        if (!read(1))
+            return value;
+    }
+
+    mValid = false; // Longer than any number we write
+    return 0;
+}
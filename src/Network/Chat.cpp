@@ -138,6 +138,7 @@ void Chat::update()
 
 void Chat::draw(sf::RenderTarget *target, sf::RenderStates states)
 {
+    #ifndef FISSION_HEADLESS // There's no font or text rendering in the headless build
     if (mFont)
     {
         std::string text;
@@ -163,6 +164,7 @@ void Chat::draw(sf::RenderTarget *target, sf::RenderStates states)
         contText.move(sf::Vector2f(5, 5));
         target->draw(contText, states);
     }
+    #endif
 }
 
 void Chat::addMessage(int playerID, std::string message)
@@ -1,25 +1,56 @@
 #include <Network/NetworkManager.h>
 
 #include <iostream>
+
+#include <SFML/System/Lock.hpp>
+
 #include <Core/StateManager.h>
 #include <Core/GameObject.h>
 #include <Core/Component.h>
+#include <Core/Tracer.h>
 #include <Scene/SceneManager.h>
+#include <Network/Snapshot.h>
+#include <Network/SendScheduler.h>
 
 NetworkManager *NetworkManager::Instance;
 
+/// Peers store their connector's ID rather than a pointer into mConnectors, which moves when connectors come and go
+static int getPeerConnectorID(ENetPeer *peer)
+{
+    return (int)(size_t)peer->data;
+}
+
 NetworkManager::NetworkManager()
 {
     Instance = this;
 
+    mType = NetworkType::SERVER; // Until we connect to someone, we're our own authority
+    mConnected = false;
+
     mNextID = 1;
     mNetworkID = -1; // Set to -1 for no connection
 
+    mHost = NULL;
+    mPeer = NULL;
+
+    mInterestRadius = 160.f;
+    mInterestLeaveRadius = 200.f;
+
+    mSnapshotBandwidth = 32*1024;
+
+    mThread = NULL;
+    mThreadRunning = false;
+
     enet_initialize();
 }
 
 NetworkManager::~NetworkManager()
 {
+    stopThread();
+
+    for (unsigned int i = 0; i < mConnectors.size(); i++)
+        delete mConnectors[i].mScheduler;
+
     enet_deinitialize();
 }
 
@@ -42,6 +73,8 @@ void NetworkManager::hostServer(int port)
         std::cout << "Successfully started server.\n";
         mNetworkID = 0; // Server gets a network ID of 0
         mConnected = true;
+
+        startThread();
     }
 }
 
@@ -76,14 +109,30 @@ void NetworkManager::connectClient(std::string ipAddress, int port)
         return;
     }
 
-    // Wait five seconds for network ID
+    // Wait five seconds for network ID. It comes first, and whatever was sent along with it is handled like
+    // anything else that arrives
     if (enet_host_service(mHost, &event, 10000) > 0 &&
         event.type == ENET_EVENT_TYPE_RECEIVE)
     {
-        sf::Packet packet;
-        packet.append(event.packet->data+0, event.packet->dataLength-0);
-        packet >> mNetworkID;
-        packet.clear();
+        NetworkEvent received;
+        received.mType = event.type;
+        received.mConnectorID = 0;
+        received.mPeer = event.peer;
+        received.mIPAddress = ipAddress;
+        received.mPort = port;
+
+        std::vector <NetworkEvent> messages;
+        unpackMessages(event.packet->data, event.packet->dataLength, received, messages);
+        enet_packet_destroy(event.packet);
+
+        if (messages.empty() || !(messages[0].mPacket >> mNetworkID))
+        {
+            enet_peer_reset(mPeer);
+            std::cout << "Connection to " << ipAddress << " failed.\n";
+            return;
+        }
+
+        mEvents.insert(mEvents.end(), messages.begin()+1, messages.end());
         std::cout << "Connection to " << ipAddress << " with ID " << mNetworkID <<  " succeeded.\n";
     }
     else
@@ -96,6 +145,8 @@ void NetworkManager::connectClient(std::string ipAddress, int port)
     // We are now connected
     mConnected = true;
     mType = NetworkType::CLIENT;
+
+    startThread();
 }
 
 bool NetworkManager::update(float dt)
@@ -103,42 +154,38 @@ bool NetworkManager::update(float dt)
     if (!mConnected)
         return true;
 
-    ENetEvent event;
-    char ipcstr[100];
-    std::string IP;
+    // Take everything that's arrived, so the network thread can carry on filling the queue while we handle it
+    std::vector <NetworkEvent> events;
+    mEventMutex.lock();
+    events.swap(mEvents);
+    mEventMutex.unlock();
 
-    // Check for events, but don't wait
-    for (int netIteration = 0; netIteration < 10000; netIteration++)
+    for (unsigned int e = 0; e < events.size(); e++)
     {
-        if (!(enet_host_service(mHost, &event, 1) > 0))
-            break;
-
-        enet_address_get_host_ip(&event.peer->address, ipcstr, 100);
-        IP = ipcstr;
+        NetworkEvent &event = events[e];
 
-        switch (event.type)
+        switch (event.mType)
         {
             case ENET_EVENT_TYPE_CONNECT:
             {
-                std::cout << "New connector " << mNextID << " from " << IP << ":" << event.peer->address.port << std::endl;
+                std::cout << "New connector " << event.mConnectorID << " from " << event.mIPAddress << ":" << event.mPort << std::endl;
 
                 // Add the new connector
                 Connector connector;
-                connector.mID = mNextID;
-                connector.mIPAddress = IP;
-                connector.mPeer = event.peer;
+                connector.mID = event.mConnectorID;
+                connector.mIPAddress = event.mIPAddress;
+                connector.mPeer = event.mPeer;
+                connector.mScene = SceneManager::get()->getMainScene(); // The game can move it somewhere else
+                connector.mScheduler = new SendScheduler;
                 mConnectors.push_back(connector);
-                mNextID++;
-
-                event.peer->data = &mConnectors.back();
 
                 // Send the client its ID
                 sf::Packet idPacket;
                 idPacket << connector.mID;
                 send(idPacket, connector.mID);
-                enet_host_flush(mHost);
                 idPacket.clear();
 
+                Scene::Binding binding(connector.mScene);
                 StateManager::get()->getCurrentState()->onConnect(connector.mID);
 
                 break;
@@ -146,8 +193,10 @@ bool NetworkManager::update(float dt)
 
             case ENET_EVENT_TYPE_RECEIVE:
             {
-                sf::Packet packet;
-                packet.append(event.packet->data+0, event.packet->dataLength-0);
+                sf::Packet &packet = event.mPacket;
+
+                // Everything the packet does happens in its connector's scene
+                Scene::Binding binding(mType == NetworkType::SERVER ? findConnector(event.mConnectorID).mScene : NULL);
 
                 // Extract the packet ID without moving forward in the packet
                 int packetID;
@@ -158,12 +207,15 @@ bool NetworkManager::update(float dt)
                     case PacketType::COMPONENT_MESSAGE:
                     {
                         int objID; // GameObject's ID
-                        std::string name; // Component name
-                        packet >> objID >> name; // Get the essentials
+                        sf::Uint32 nameID; // Component name's symbol ID
+                        packet >> objID >> nameID; // Get the essentials
+                        // IDs carry a generation, so a message for an object that's gone can't reach one that
+                        // took its slot
                         GameObject *object = SceneManager::get()->findGameObject(objID);
                         if (object)
                         {
-                            Component *component = object->getComponent<Component>(name);
+                            object->wake(); // Messages usually mean something is about to happen to it
+                            Component *component = object->getComponent<Component>(Symbol::fromID(nameID));
                             if (component)
                                 component->handlePacket(packet);
                         }
@@ -182,20 +234,44 @@ bool NetworkManager::update(float dt)
                         break;
                     }
 
+                    case PacketType::SCENE_UPDATE:
+                    {
+                        sf::Uint32 sequence = SceneManager::get()->getCurrentScene()->deserializeUpdatePacket(packet);
+                        if (sequence != 0) // Let the server know it can send deltas against this one
+                        {
+                            sf::Packet ackPacket;
+                            ackPacket << PacketType::SNAPSHOT_ACK << sequence;
+                            send(ackPacket, 0, 0, false);
+                        }
+                        break;
+                    }
+
+                    case PacketType::SNAPSHOT_ACK:
+                    {
+                        sf::Uint32 sequence;
+                        if (packet >> sequence)
+                        {
+                            for (unsigned int i = 0; i < mConnectors.size(); i++)
+                            {
+                                // Acks can arrive out of order, and an old baseline only makes the deltas bigger
+                                if (mConnectors[i].mID == event.mConnectorID && sequence > mConnectors[i].mAckedSnapshot)
+                                    mConnectors[i].mAckedSnapshot = sequence;
+                            }
+                        }
+                        break;
+                    }
+
                     default:
                     {
                         packet.reset();
                         if (mType == NetworkType::SERVER)
-                            StateManager::get()->getCurrentState()->handlePacket(packet, ((Connector*)event.peer->data)->mID);
+                            StateManager::get()->getCurrentState()->handlePacket(packet, event.mConnectorID);
                         else if (mType == NetworkType::CLIENT)
                             StateManager::get()->getCurrentState()->handlePacket(packet, 0);
                         break;
                     }
                 }
 
-                enet_packet_destroy(event.packet);
-                packet.clear();
-
                 break;
             }
 
@@ -205,13 +281,17 @@ bool NetworkManager::update(float dt)
                 {
                     std::cout << "Disconnected from server\n";
                     mConnected = false;
+
+                    // Nothing will flush these now
+                    sf::Lock lock(mOutgoingMutex);
+                    mOutgoing.clear();
                 }
                 else if (mType == NetworkType::SERVER)
                 {
-                    std::cout << "Connector " << ((Connector*)event.peer->data)->mID << " has disconnected.\n";
-                    StateManager::get()->getCurrentState()->onDisconnect(((Connector*)event.peer->data)->mID);
-                    removeConnector(((Connector*)event.peer->data)->mID);
-                    event.peer->data = NULL;
+                    std::cout << "Connector " << event.mConnectorID << " has disconnected.\n";
+                    Scene::Binding binding(findConnector(event.mConnectorID).mScene);
+                    StateManager::get()->getCurrentState()->onDisconnect(event.mConnectorID);
+                    removeConnector(event.mConnectorID);
                 }
 
                 break;
@@ -224,53 +304,101 @@ bool NetworkManager::update(float dt)
         }
     }
 
+    if (mType == NetworkType::SERVER)
+        sendSnapshots(dt);
+
+    flush();
+
     return true;
 }
 
 void NetworkManager::send(sf::Packet packet, int connectorID, int excludeID, bool reliable)
 {
-    sf::Packet finalPacket;
-    //finalPacket << sf::Int8(0);
-    finalPacket.append(packet.getData(), packet.getDataSize());
-
-    // Create the enet packet
-    unsigned int flags = ENET_PACKET_FLAG_NO_ALLOCATE;
-    if (reliable)
-        flags |= ENET_PACKET_FLAG_RELIABLE;
+    if (!mHost || !mConnected) // Only flushed while connected
+        return;
 
-    ENetPacket *enetPacket = enet_packet_create(finalPacket.getData(), finalPacket.getDataSize(), flags);
+    const char *data = (const char*)packet.getData();
+    unsigned int size = packet.getDataSize();
 
     if (mType == NetworkType::CLIENT) // Clients send data to server only
     {
-        enet_host_broadcast(mHost, 0, enetPacket);
+        queueMessage(mPeer, data, size, reliable);
     }
     else if (connectorID > 0) // It's a server and the client is specified. Tell only that client!
     {
-        enet_peer_send(findConnector(connectorID).mPeer, 0, enetPacket);
+        ENetPeer *peer = findConnector(connectorID).mPeer;
+        if (peer)
+            queueMessage(peer, data, size, reliable);
+    }
+    else // It's a server and the client is unspecified. Broadcast to everyone in the scene it came from
+    {
+        Scene *scene = SceneManager::get()->getCurrentScene();
+        for (unsigned int i = 0; i < mConnectors.size(); i++)
+        {
+            if (mConnectors[i].mID != excludeID && mConnectors[i].mScene == scene)
+                queueMessage(mConnectors[i].mPeer, data, size, reliable);
+        }
     }
-    else // It's a server and the client is unspecified. Broadcast to everyone
+}
+
+void NetworkManager::flush()
+{
+    TRACE_SCOPE("NetworkManager::flush");
+
+    sf::Lock outgoingLock(mOutgoingMutex);
+    if (mOutgoing.empty())
+        return;
+
+    sf::Lock lock(mHostMutex);
+
+    // Reliable first, so an object is created before an unreliable update about it turns up
+    for (unsigned int pass = 0; pass < 2; pass++)
     {
-        if (excludeID > 0)
+        for (unsigned int q = 0; q < mOutgoing.size(); q++)
         {
-            for (unsigned int i = 0; i < mConnectors.size(); i++)
+            OutgoingQueue &queue = mOutgoing[q];
+            if (queue.mReliable != (pass == 0))
+                continue;
+
+            // The most that fits in one datagram. Anything bigger gets split into fragments by enet
+            unsigned int maxSize = queue.mPeer->mtu-sizeof(ENetProtocolHeader)-sizeof(ENetProtocolSendFragment);
+
+            // Messages are never split, so a datagram ends after the last one that fits, or after one that's too big
+            // to fit anywhere
+            unsigned int begin = 0;
+            for (unsigned int m = 0; m < queue.mEnds.size(); m++)
             {
-                if (mConnectors[i].mID != excludeID)
-                    enet_peer_send(findConnector(connectorID).mPeer, 0, enetPacket);
+                unsigned int end = queue.mEnds[m];
+                if (m+1 < queue.mEnds.size() && queue.mEnds[m+1]-begin <= maxSize)
+                    continue;
+
+                ENetPacket *enetPacket = enet_packet_create(&queue.mData[begin], end-begin, queue.mReliable ? ENET_PACKET_FLAG_RELIABLE : 0);
+                if (enet_peer_send(queue.mPeer, 0, enetPacket) < 0) // Not connected any more
+                    enet_packet_destroy(enetPacket);
+
+                begin = end;
             }
         }
-        else
-            enet_host_broadcast(mHost, 0, enetPacket);
     }
 
-    enet_host_flush(mHost);
-    finalPacket.clear();
+    mOutgoing.clear();
+
+    {
+        TRACE_SCOPE("enet_host_flush");
+        enet_host_flush(mHost);
+    }
 }
 
 void NetworkManager::sendSceneCreation(int connectorID, int excludeID, bool reliable)
 {
+    // A connector is sent the scene it's in
+    Scene *scene = SceneManager::get()->getCurrentScene();
+    if (connectorID > 0 && findConnector(connectorID).mScene)
+        scene = findConnector(connectorID).mScene;
+
     sf::Packet packet;
     packet << PacketType::SCENE_CREATION;
-    SceneManager::get()->getCurrentScene()->serializeCreationPacket(packet);
+    scene->serializeCreationPacket(packet);
 
     send(packet, connectorID, excludeID, reliable);
 }
@@ -289,7 +417,7 @@ void NetworkManager::sendToComponent(sf::Packet packet, GameObject *object, Comp
     sf::Packet finalPacket;
     finalPacket << PacketType::COMPONENT_MESSAGE;
     finalPacket << object->getID();
-    finalPacket << component->getName();
+    finalPacket << sf::Uint32(component->getName().getID()); // Both ends know the name, so only its ID is sent
     finalPacket.append(packet.getData(), packet.getDataSize());
 
     send(finalPacket, connectorID, excludeID, reliable);
@@ -323,8 +451,259 @@ void NetworkManager::removeConnector(int ID)
     {
         if (mConnectors[i].mID == ID)
         {
+            // Its peer may be handed to someone else, who shouldn't get what it was sent
+            {
+                sf::Lock lock(mOutgoingMutex);
+                for (unsigned int q = 0; q < mOutgoing.size(); q++)
+                {
+                    if (mOutgoing[q].mPeer == mConnectors[i].mPeer)
+                        mOutgoing.erase(mOutgoing.begin()+q--);
+                }
+            }
+
+            delete mConnectors[i].mScheduler;
             mConnectors.erase(mConnectors.begin()+i);
             return;
         }
     }
 }
+
+void NetworkManager::setConnectorScene(int ID, Scene *scene)
+{
+    for (unsigned int i = 0; i < mConnectors.size(); i++)
+    {
+        if (mConnectors[i].mID == ID)
+            mConnectors[i].mScene = scene;
+    }
+}
+
+void NetworkManager::moveConnectors(Scene *from, Scene *to)
+{
+    for (unsigned int i = 0; i < mConnectors.size(); i++)
+    {
+        if (mConnectors[i].mScene == from)
+            mConnectors[i].mScene = to;
+    }
+}
+
+void NetworkManager::setConnectorFocus(int ID, GameObject *object)
+{
+    for (unsigned int i = 0; i < mConnectors.size(); i++)
+    {
+        if (mConnectors[i].mID != ID)
+            continue;
+
+        mConnectors[i].mFocus = object ? object->getHandle() : Handle();
+    }
+}
+
+void NetworkManager::sendSnapshots(float dt)
+{
+    TRACE_SCOPE("NetworkManager::sendSnapshots");
+
+    std::vector <Scene*> &scenes = SceneManager::get()->getScenes();
+    for (unsigned int s = 0; s < scenes.size(); s++)
+    {
+        Scene *scene = scenes[s];
+
+        // Scenes nobody is in aren't snapshotted at all
+        bool taken = false;
+        sf::Uint32 sequence = 0;
+        for (unsigned int i = 0; i < mConnectors.size(); i++)
+        {
+            if (mConnectors[i].mScene != scene)
+                continue;
+
+            if (!taken)
+            {
+                sequence = scene->takeSnapshot();
+                taken = true;
+            }
+
+            Connector &connector = mConnectors[i];
+            SendScheduler *scheduler = connector.mScheduler;
+            GameObject *focus = GameObject::get(connector.mFocus);
+
+            // What the connector should see of each new scene snapshot. With a focus that's what's around it, so
+            // objects that came into view are sent whole and ones that went out of it are sent as removed
+            if (scheduler->getTargetSequence() != sequence)
+            {
+                if (focus)
+                {
+                    Snapshot interest;
+                    scene->getInterestSnapshot(focus->getPosition(), mInterestRadius, mInterestLeaveRadius, &scheduler->getTarget(), interest);
+                    scheduler->setTarget(interest, sequence);
+                }
+                else
+                {
+                    scheduler->setTarget(scene->getSnapshot(), sequence);
+                }
+            }
+
+            sf::Packet packet;
+            packet << PacketType::SCENE_UPDATE;
+            if (!scheduler->buildUpdate(packet, connector.mAckedSnapshot, dt, getSnapshotBandwidth(connector),
+                                        focus ? focus->getPosition() : sf::Vector2f(), focus != NULL))
+                continue;
+
+            // Unreliable, since the next one is sent against whatever did arrive
+            send(packet, connector.mID, 0, false);
+        }
+    }
+}
+
+float NetworkManager::getSnapshotBandwidth(const Connector &connector)
+{
+    sf::Lock lock(mHostMutex);
+
+    // Clients say how much they can take when they connect. enet throttles a link back as it starts losing packets
+    // or its round trip grows, and the updates are cut back with it rather than left for enet to drop
+    float bandwidth = connector.mPeer->incomingBandwidth > 0 ? (float)connector.mPeer->incomingBandwidth : mSnapshotBandwidth;
+    return bandwidth*connector.mPeer->packetThrottle/ENET_PEER_PACKET_THROTTLE_SCALE;
+}
+
+void NetworkManager::threadMain(NetworkManager *network)
+{
+    Tracer::get()->setThreadName("Network");
+
+    while (network->getThreadRunning())
+    {
+        // Sleep until something arrives, without holding the host so the main thread can still send. The timeout
+        // keeps enet's resends and timeouts going when nothing does
+        enet_uint32 condition = ENET_SOCKET_WAIT_RECEIVE;
+        enet_socket_wait(network->mHost->socket, &condition, 5);
+
+        network->serviceHost();
+    }
+}
+
+void NetworkManager::startThread()
+{
+    if (mThread)
+        return;
+
+    mThreadRunning = true;
+    mThread = new sf::Thread(&NetworkManager::threadMain, this);
+    mThread->launch();
+}
+
+void NetworkManager::stopThread()
+{
+    if (!mThread)
+        return;
+
+    mEventMutex.lock();
+    mThreadRunning = false;
+    mEventMutex.unlock();
+
+    mThread->wait();
+    delete mThread;
+    mThread = NULL;
+}
+
+bool NetworkManager::getThreadRunning()
+{
+    sf::Lock lock(mEventMutex);
+    return mThreadRunning;
+}
+
+void NetworkManager::serviceHost()
+{
+    TRACE_SCOPE("enet_host_service");
+
+    sf::Lock lock(mHostMutex);
+
+    ENetEvent event;
+    char ipcstr[100];
+    while (enet_host_service(mHost, &event, 0) > 0)
+    {
+        NetworkEvent networkEvent;
+        networkEvent.mType = event.type;
+        networkEvent.mPeer = event.peer;
+        networkEvent.mPort = event.peer->address.port;
+
+        enet_address_get_host_ip(&event.peer->address, ipcstr, 100);
+        networkEvent.mIPAddress = ipcstr;
+
+        if (event.type == ENET_EVENT_TYPE_CONNECT && mType == NetworkType::SERVER)
+            event.peer->data = (void*)(size_t)mNextID++; // Handed out here so the disconnect can't arrive before it
+        networkEvent.mConnectorID = getPeerConnectorID(event.peer);
+
+        sf::Lock eventLock(mEventMutex);
+        if (event.type == ENET_EVENT_TYPE_RECEIVE)
+        {
+            unpackMessages(event.packet->data, event.packet->dataLength, networkEvent, mEvents);
+            enet_packet_destroy(event.packet);
+        }
+        else
+        {
+            mEvents.push_back(networkEvent);
+        }
+    }
+}
+
+void NetworkManager::queueMessage(ENetPeer *peer, const char *data, unsigned int size, bool reliable)
+{
+    sf::Lock lock(mOutgoingMutex);
+
+    OutgoingQueue *queue = NULL;
+    for (unsigned int q = 0; q < mOutgoing.size() && !queue; q++)
+    {
+        if (mOutgoing[q].mPeer == peer && mOutgoing[q].mReliable == reliable)
+            queue = &mOutgoing[q];
+    }
+
+    if (!queue)
+    {
+        mOutgoing.push_back(OutgoingQueue());
+        queue = &mOutgoing.back();
+        queue->mPeer = peer;
+        queue->mReliable = reliable;
+    }
+
+    // Two bytes of length in front of each message, or those two bytes all set and four more for a long one
+    if (size < 0xFFFF)
+    {
+        queue->mData.push_back((char)(size >> 8));
+        queue->mData.push_back((char)size);
+    }
+    else
+    {
+        queue->mData.push_back((char)0xFF);
+        queue->mData.push_back((char)0xFF);
+        for (int shift = 24; shift >= 0; shift -= 8)
+            queue->mData.push_back((char)(size >> shift));
+    }
+
+    queue->mData.insert(queue->mData.end(), data, data+size);
+    queue->mEnds.push_back(queue->mData.size());
+}
+
+void NetworkManager::unpackMessages(const enet_uint8 *data, unsigned int size, const NetworkEvent &event, std::vector <NetworkEvent> &events)
+{
+    unsigned int position = 0;
+    while (position+2 <= size)
+    {
+        unsigned int length = (data[position] << 8) | data[position+1];
+        position += 2;
+
+        if (length == 0xFFFF)
+        {
+            if (position+4 > size)
+                break;
+
+            length = ((unsigned int)data[position] << 24) | (data[position+1] << 16) | (data[position+2] << 8) | data[position+3];
+            position += 4;
+        }
+
+        if (length > size-position) // Cut short. What made it is still handled
+        {
+            std::cout << "Received a message longer than its packet\n";
+            break;
+        }
+
+        events.push_back(event);
+        events.back().mPacket.append(data+position, length);
+        position += length;
+    }
+}
@@ -0,0 +1,216 @@
+/*
+SendScheduler.cpp
+Theodore DeRego
+Copyright 2012
+
+SendScheduler implementation
+*/
+
+#include "Network/SendScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Scene/Scene.h"
+
+/// Bytes every update costs however little is in it: the packet type, the sequence numbers and the block length
+static const unsigned int HeaderBytes = 16;
+
+/// The most the budget builds up to, in seconds of bandwidth, so a quiet spell isn't followed by a flood
+static const float MaxBurst = 0.25f;
+
+/// Objects coming into view build up priority this much faster, so they don't pop in late
+static const float EnterWeight = 2.f;
+
+/// Highest priority first
+static bool comparePriorities(const std::pair <float, unsigned int> &a, const std::pair <float, unsigned int> &b)
+{
+    return a.first > b.first;
+}
+
+SendScheduler::SendScheduler()
+{
+    mTargetSequence = 0;
+    mBudget = 0;
+
+    mDistanceScale = 160.f;
+    mVelocityScale = 4.f;
+}
+
+SendScheduler::~SendScheduler()
+{
+    //dtor
+}
+
+void SendScheduler::setTarget(const Snapshot &target, sf::Uint32 sceneSequence)
+{
+    mTarget = target;
+    mTargetSequence = sceneSequence;
+}
+
+bool SendScheduler::buildUpdate(sf::Packet &packet, sf::Uint32 acked, float dt, float bandwidth, sf::Vector2f focus, bool hasFocus)
+{
+    const Snapshot &sent = mSent.getLatest();
+
+    // Everything the client is behind on builds up priority, whether or not it gets sent this time. Objects it's
+    // caught up on drop out, so they start from nothing when they next change
+    std::vector <unsigned int> pending;
+    std::vector <int> removed;
+    mTarget.diff(&sent, pending, removed);
+
+    std::vector <std::pair <int, float> > priorities;
+    priorities.reserve(pending.size());
+    unsigned int p = 0;
+    for (unsigned int i = 0; i < pending.size(); i++)
+    {
+        const ObjectState &state = mTarget.mObjects[pending[i]];
+
+        while (p < mPriorities.size() && mPriorities[p].first < state.mID)
+            p++;
+
+        float priority = 0;
+        if (p < mPriorities.size() && mPriorities[p].first == state.mID)
+            priority = mPriorities[p].second;
+
+        priority += getWeight(state, sent.findObject(state.mID), focus, hasFocus)*dt;
+        priorities.push_back(std::make_pair(state.mID, priority));
+    }
+    mPriorities.swap(priorities);
+
+    mBudget = std::min(mBudget+bandwidth*dt, bandwidth*MaxBurst);
+
+    if (pending.empty() && removed.empty() && acked == sent.mSequence) // Up to date
+        return false;
+    if (mBudget <= 0)
+        return false;
+
+    const Snapshot *baseline = mSent.find(acked);
+    if (!baseline) // Too old. Start the client over from nothing
+        baseline = mSent.find(0);
+
+    // What's already owed comes first. Everything sent since the baseline goes again until the client acknowledges
+    // it, and objects that aren't in the target any more are removed
+    Snapshot owed;
+    owed.mObjects.reserve(sent.mObjects.size());
+    unsigned int t = 0;
+    for (unsigned int s = 0; s < sent.mObjects.size(); s++)
+    {
+        while (t < mTarget.mObjects.size() && mTarget.mObjects[t].mID < sent.mObjects[s].mID)
+            t++;
+
+        if (t < mTarget.mObjects.size() && mTarget.mObjects[t].mID == sent.mObjects[s].mID)
+            owed.mObjects.push_back(sent.mObjects[s]);
+    }
+
+    std::vector <unsigned int> owedChanged;
+    std::vector <unsigned int> owedFields;
+    std::vector <int> owedRemoved;
+    owed.diff(baseline, owedChanged, owedRemoved, &owedFields);
+
+    int bits = (HeaderBytes+owedRemoved.size())*8;
+    for (unsigned int o = 0; o < owedFields.size(); o++)
+        bits += Snapshot::getStateBits(owedFields[o]);
+
+    // Sending again what hasn't been acknowledged yet only pays off once there's room for at least as much that's
+    // new, so a slow link waits and sends fewer, fuller updates. A full budget always sends, or a client that's owed
+    // more than the budget holds would never get anything
+    int budgetBits = (int)(mBudget*8);
+    if ((pending.empty() ? bits : bits*2) > budgetBits && mBudget < bandwidth*MaxBurst)
+        return false;
+
+    // Then the highest priorities, while they fit. The first one always goes if there's anything left, so an object
+    // bigger than the budget can't hold everything up
+    std::vector <std::pair <float, unsigned int> > order;
+    order.reserve(pending.size());
+    for (unsigned int i = 0; i < pending.size(); i++)
+        order.push_back(std::make_pair(mPriorities[i].second, i));
+    std::sort(order.begin(), order.end(), comparePriorities);
+
+    std::vector <bool> chosen(mTarget.mObjects.size(), false);
+    bool anyChosen = false;
+    for (unsigned int o = 0; o < order.size() && bits < budgetBits; o++)
+    {
+        unsigned int i = order[o].second;
+        const ObjectState &state = mTarget.mObjects[pending[i]];
+
+        // What it adds to the delta, less what it was already costing as part of what's owed
+        const ObjectState *baselineState = baseline->findObject(state.mID);
+        const ObjectState *sentState = owed.findObject(state.mID);
+        int cost = Snapshot::getStateBits(baselineState ? state.getChangedFields(*baselineState) : SnapshotField::ALL);
+        if (sentState)
+        {
+            unsigned int sentFields = baselineState ? sentState->getChangedFields(*baselineState) : SnapshotField::ALL;
+            if (sentFields != 0)
+                cost -= Snapshot::getStateBits(sentFields);
+        }
+
+        if (bits+cost > budgetBits && anyChosen)
+            continue;
+
+        chosen[pending[i]] = true;
+        anyChosen = true;
+        mPriorities[i].second = 0;
+        bits += cost;
+    }
+
+    if (anyChosen || !removed.empty())
+    {
+        // What was sent before, with the chosen objects brought up to date
+        Snapshot next;
+        next.mObjects.reserve(mTarget.mObjects.size());
+        for (unsigned int i = 0, s = 0; i < mTarget.mObjects.size(); i++)
+        {
+            const ObjectState &state = mTarget.mObjects[i];
+            while (s < sent.mObjects.size() && sent.mObjects[s].mID < state.mID)
+                s++;
+
+            if (chosen[i])
+                next.mObjects.push_back(state);
+            else if (s < sent.mObjects.size() && sent.mObjects[s].mID == state.mID)
+                next.mObjects.push_back(sent.mObjects[s]);
+        }
+
+        next.mSequence = SnapshotHistory::allocateSequence();
+        mSent.add(next);
+    }
+
+    const Snapshot &latest = mSent.getLatest();
+    if (latest.mSequence == acked)
+        return false;
+
+    // Adding a snapshot can push the baseline out of the history
+    baseline = mSent.find(acked);
+    if (!baseline)
+        baseline = mSent.find(0);
+
+    unsigned int size = packet.getDataSize();
+    Scene::serializeUpdatePacket(packet, latest, baseline);
+    mBudget -= packet.getDataSize()-size;
+
+    return true;
+}
+
+float SendScheduler::getWeight(const ObjectState &state, const ObjectState *sent, sf::Vector2f focus, bool hasFocus)
+{
+    float weight = 1.f;
+
+    if (!sent)
+    {
+        weight *= EnterWeight;
+    }
+    else
+    {
+        float x = state.mFields[SnapshotField::VELOCITY_X]-sent->mFields[SnapshotField::VELOCITY_X];
+        float y = state.mFields[SnapshotField::VELOCITY_Y]-sent->mFields[SnapshotField::VELOCITY_Y];
+        weight *= 1.f+std::sqrt(x*x+y*y)/mVelocityScale;
+    }
+
+    if (hasFocus)
+    {
+        float x = state.mFields[SnapshotField::POSITION_X]-focus.x;
+        float y = state.mFields[SnapshotField::POSITION_Y]-focus.y;
+        weight *= mDistanceScale/(mDistanceScale+std::sqrt(x*x+y*y));
+    }
+
+    return weight;
+}
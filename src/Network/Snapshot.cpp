@@ -0,0 +1,281 @@
+/*
+Snapshot.cpp
+Theodore DeRego
+Copyright 2012
+
+Snapshot implementation
+*/
+
+#include "Network/Snapshot.h"
+
+#include <algorithm>
+
+// A sixty-fourth of a unit anywhere in a world 8192 units across, and velocities clamped to what objects reach in play
+Quantization Snapshot::Quantizations[SnapshotField::COUNT] = {Quantization::fromResolution(-4096.f, 4096.f, 1.f/64.f),
+                                                              Quantization::fromResolution(-4096.f, 4096.f, 1.f/64.f),
+                                                              Quantization(0.f, 360.f, 10, true),
+                                                              Quantization(-256.f, 256.f, 16),
+                                                              Quantization(-256.f, 256.f, 16),
+                                                              Quantization(-64.f, 64.f, 12)};
+
+Snapshot SnapshotHistory::Empty;
+std::atomic <sf::Uint32> SnapshotHistory::NextSequence(1);
+
+static bool compareIDs(const ObjectState &a, const ObjectState &b)
+{
+    return a.mID < b.mID;
+}
+
+/// Binary search through objects sorted by ID
+static const ObjectState *findState(const std::vector <ObjectState> &objects, int ID)
+{
+    ObjectState key;
+    key.mID = ID;
+
+    std::vector <ObjectState>::const_iterator state = std::lower_bound(objects.begin(), objects.end(), key, compareIDs);
+    if (state != objects.end() && state->mID == ID)
+        return &*state;
+
+    return NULL;
+}
+
+unsigned int ObjectState::getChangedFields(const ObjectState &other) const
+{
+    unsigned int fields = 0;
+    for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+    {
+        if (mFields[f] != other.mFields[f])
+            fields |= 1 << f;
+    }
+
+    return fields;
+}
+
+void ObjectState::quantize()
+{
+    for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+        mFields[f] = Snapshot::getQuantization(f).quantize(mFields[f]);
+}
+
+const ObjectState *Snapshot::findObject(int ID) const
+{
+    return findState(mObjects, ID);
+}
+
+bool Snapshot::matches(const Snapshot &other) const
+{
+    if (mObjects.size() != other.mObjects.size())
+        return false;
+
+    for (unsigned int o = 0; o < mObjects.size(); o++)
+    {
+        if (mObjects[o].mID != other.mObjects[o].mID || mObjects[o].getChangedFields(other.mObjects[o]) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+void Snapshot::sort()
+{
+    std::sort(mObjects.begin(), mObjects.end(), compareIDs);
+}
+
+void Snapshot::diff(const Snapshot *older, std::vector <unsigned int> &changed, std::vector <int> &removed,
+                    std::vector <unsigned int> *changedFields) const
+{
+    static const std::vector <ObjectState> NoObjects;
+    const std::vector <ObjectState> &oldObjects = older ? older->mObjects : NoObjects;
+
+    // Both lists are sorted by ID, so one walk through them finds what changed, what's new and what's gone
+    unsigned int b = 0;
+    for (unsigned int o = 0; o < mObjects.size(); o++)
+    {
+        const ObjectState &state = mObjects[o];
+
+        while (b < oldObjects.size() && oldObjects[b].mID < state.mID)
+            removed.push_back(oldObjects[b++].mID);
+
+        unsigned int fields = SnapshotField::ALL; // New objects are sent whole
+        if (b < oldObjects.size() && oldObjects[b].mID == state.mID)
+            fields = state.getChangedFields(oldObjects[b++]);
+
+        if (fields != 0)
+        {
+            changed.push_back(o);
+            if (changedFields)
+                changedFields->push_back(fields);
+        }
+    }
+
+    while (b < oldObjects.size())
+        removed.push_back(oldObjects[b++].mID);
+}
+
+unsigned int Snapshot::getStateBits(unsigned int fields)
+{
+    unsigned int bits = 8+SnapshotField::COUNT;
+    for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+    {
+        if (fields & (1 << f))
+            bits += Quantizations[f].mBits;
+    }
+
+    return bits;
+}
+
+void Snapshot::serializeDelta(BitWriter &writer, const Snapshot *baseline) const
+{
+    std::vector <unsigned int> changed;
+    std::vector <unsigned int> changedFields;
+    std::vector <int> removed;
+    diff(baseline, changed, removed, &changedFields);
+
+    // IDs go up, so each is sent as the gap from the one before, which is usually small. What's gone comes first,
+    // so the reader can rebuild the snapshot in one pass
+    writer.writeVariable(removed.size());
+    int previousID = 0;
+    for (unsigned int r = 0; r < removed.size(); r++)
+    {
+        writer.writeVariable(removed[r]-previousID);
+        previousID = removed[r];
+    }
+
+    writer.writeVariable(changed.size());
+    previousID = 0;
+    for (unsigned int c = 0; c < changed.size(); c++)
+    {
+        const ObjectState &state = mObjects[changed[c]];
+        unsigned int fields = changedFields[c];
+
+        writer.writeVariable(state.mID-previousID);
+        writer.write(fields, SnapshotField::COUNT);
+        previousID = state.mID;
+
+        for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+        {
+            if (fields & (1 << f))
+                writer.writeFloat(state.mFields[f], Quantizations[f]);
+        }
+    }
+}
+
+bool Snapshot::deserializeDelta(BitReader &reader, const Snapshot *baseline)
+{
+    static const std::vector <ObjectState> NoObjects;
+    const std::vector <ObjectState> &oldObjects = baseline ? baseline->mObjects : NoObjects;
+
+    std::vector <int> removed;
+    unsigned int removedCount = reader.readVariable();
+    int ID = 0;
+    for (unsigned int r = 0; r < removedCount && reader.getValid(); r++)
+    {
+        ID += reader.readVariable();
+        removed.push_back(ID);
+    }
+
+    mObjects.clear();
+    mObjects.reserve(oldObjects.size());
+
+    // Walk through the baseline alongside the delta. Both are in ID order, so what comes out is too
+    unsigned int b = 0;
+    unsigned int r = 0;
+    unsigned int changedCount = reader.readVariable();
+    ID = 0;
+    for (unsigned int c = 0; c <= changedCount && reader.getValid(); c++)
+    {
+        int nextID = 0x7FFFFFFF; // Past the last one, so the rest of the baseline carries over
+        if (c < changedCount)
+        {
+            unsigned int gap = reader.readVariable();
+            if (gap == 0) // IDs only go up
+                return false;
+
+            ID += gap;
+            nextID = ID;
+        }
+
+        // Objects in between haven't changed, unless they're gone
+        for (; b < oldObjects.size() && oldObjects[b].mID < nextID; b++)
+        {
+            while (r < removed.size() && removed[r] < oldObjects[b].mID)
+                r++;
+
+            if (r == removed.size() || removed[r] != oldObjects[b].mID)
+                mObjects.push_back(oldObjects[b]);
+        }
+
+        if (c == changedCount)
+            break;
+
+        // Fields that weren't sent haven't changed since the baseline
+        ObjectState state;
+        if (b < oldObjects.size() && oldObjects[b].mID == ID)
+            state = oldObjects[b++];
+        state.mID = ID;
+
+        unsigned int fields = reader.read(SnapshotField::COUNT);
+        for (unsigned int f = 0; f < SnapshotField::COUNT; f++)
+        {
+            if (fields & (1 << f))
+                state.mFields[f] = reader.readFloat(Quantizations[f]);
+        }
+
+        mObjects.push_back(state);
+    }
+
+    return reader.getValid();
+}
+
+SnapshotHistory::SnapshotHistory()
+{
+    mNextSlot = 0;
+    mCount = 0;
+}
+
+SnapshotHistory::~SnapshotHistory()
+{
+    //dtor
+}
+
+void SnapshotHistory::add(const Snapshot &snapshot)
+{
+    mSnapshots[mNextSlot] = snapshot;
+    mNextSlot = (mNextSlot+1)%HistoryLength;
+
+    if (mCount < HistoryLength)
+        mCount++;
+}
+
+const Snapshot *SnapshotHistory::find(sf::Uint32 sequence)
+{
+    if (sequence == 0)
+        return &Empty;
+
+    for (unsigned int s = 0; s < mCount; s++)
+    {
+        if (mSnapshots[s].mSequence == sequence)
+            return &mSnapshots[s];
+    }
+
+    return NULL;
+}
+
+const Snapshot &SnapshotHistory::getLatest()
+{
+    if (mCount == 0)
+        return Empty;
+
+    return mSnapshots[(mNextSlot+HistoryLength-1)%HistoryLength];
+}
+
+void SnapshotHistory::clear()
+{
+    mNextSlot = 0;
+    mCount = 0;
+}
+
+sf::Uint32 SnapshotHistory::allocateSequence()
+{
+    return NextSequence++;
+}
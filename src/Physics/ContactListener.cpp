@@ -0,0 +1,74 @@
+/*
+ContactListener.cpp
+Theodore DeRego
+Copyright 2012
+
+ContactListener implementation
+*/
+
+#include "Physics/ContactListener.h"
+
+#include <Core/GameObject.h>
+#include <Physics/RigidBodyComponent.h>
+
+ContactListener::ContactListener()
+{
+    //ctor
+}
+
+ContactListener::~ContactListener()
+{
+    //dtor
+}
+
+void ContactListener::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+{
+    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
+    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+
+    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
+        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
+    {
+        contact->SetEnabled(false);
+        return;
+    }
+
+    objectA->onPreSolve(objectB, contact, oldManifold);
+    objectB->onPreSolve(objectA, contact, oldManifold);
+}
+
+void ContactListener::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+{
+}
+
+void ContactListener::BeginContact(b2Contact* contact)
+{
+    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
+    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+
+    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
+        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
+    {
+        contact->SetEnabled(false);
+        return;
+    }
+
+    objectA->onContactBegin(objectB);
+    objectB->onContactBegin(objectA);
+}
+
+void ContactListener::EndContact(b2Contact* contact)
+{
+    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
+    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+
+    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
+        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
+    {
+        contact->SetEnabled(false);
+        return;
+    }
+
+    objectA->onContactEnd(objectB);
+    objectB->onContactEnd(objectA);
+}
@@ -4,21 +4,23 @@
 #include <Core/InputManager.h>
 #include <Core/GameObject.h>
 #include <Rendering/RenderingManager.h>
-#include <Physics/PhysicsManager.h>
 #include <Physics/RigidBodyComponent.h>
+#include <Scene/Scene.h>
 #include <iostream>
 
 DragComponent::DragComponent(GameObject *object, std::string name) : Component(object, name)
 {
     mMouseJoint = NULL;
     mBody = mGameObject->getComponent<RigidBodyComponent>()->getBody();
+    mScene = mGameObject->getScene();
 
     mTypeName = "DragComponent";
 }
 
 DragComponent::~DragComponent()
 {
-    PhysicsManager::get()->setDragger(NULL);
+    if (mScene && mScene->getDragger() == this)
+        mScene->setDragger(NULL);
 }
 
 bool DragComponent::update(float dt)
@@ -49,7 +51,7 @@ bool DragComponent::update(float dt)
     {
         b2MouseJointDef mousedef;
 
-        mousedef.bodyA = PhysicsManager::get()->getGroundBody();
+        mousedef.bodyA = mScene->getGroundBody();
         mousedef.bodyB = mBody;
 
         mousedef.target = mousePos;
@@ -59,9 +61,9 @@ bool DragComponent::update(float dt)
         mousedef.maxForce = 300 * mousedef.bodyB->GetMass();
 
         mBody->SetAwake(true);
-        mMouseJoint = (b2MouseJoint*)PhysicsManager::get()->getWorld()->CreateJoint(&mousedef);
+        mMouseJoint = (b2MouseJoint*)mBody->GetWorld()->CreateJoint(&mousedef);
 
-        PhysicsManager::get()->setDragger(this);
+        mScene->setDragger(this);
     }
     else if (InputManager::get()->getLMBDown() && mMouseJoint) // We are dragging this component around
     {
@@ -70,8 +72,8 @@ bool DragComponent::update(float dt)
     }
     else if (InputManager::get()->getLMBState() == ButtonState::RELEASED && mMouseJoint)
     {
-        PhysicsManager::get()->getWorld()->DestroyJoint(mMouseJoint);
-        PhysicsManager::get()->setDragger(NULL);
+        mBody->GetWorld()->DestroyJoint(mMouseJoint);
+        mScene->setDragger(NULL);
         mMouseJoint = NULL;
     }
 
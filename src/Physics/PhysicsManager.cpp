@@ -1,7 +1,8 @@
 #include "Physics/PhysicsManager.h"
 
-#include <Core/GameObject.h>
-#include <Physics/RigidBodyComponent.h>
+#include <Core/JobSystem.h>
+#include <Core/Tracer.h>
+#include <Scene/SceneManager.h>
 
 PhysicsManager *PhysicsManager::Instance = NULL;
 
@@ -9,14 +10,7 @@ PhysicsManager::PhysicsManager()
 {
     Instance = this;
 
-    mWorld = new b2World(b2Vec2(0, -10)); //gravity = 10
-    mWorld->SetContactListener(this);
-
     mTime = 0;
-
-    mGroundBody = NULL;
-
-    mDragger = NULL;
 }
 
 PhysicsManager::~PhysicsManager()
@@ -24,62 +18,54 @@ PhysicsManager::~PhysicsManager()
     //dtor
 }
 
-bool PhysicsManager::update(float dt)
+/// Everything a worker needs to step a range of scenes
+struct WorldStep
 {
-    mWorld->Step(dt, 8, 3);
-    mTime++;
-
-    return true;
-}
+    std::vector <Scene*> *mScenes;
+    float mDeltaTime;
+};
 
-void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+static void stepWorldJob(void *data, unsigned int begin, unsigned int end)
 {
-    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
-    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+    WorldStep *step = (WorldStep*)data;
 
-    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
-        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
+    for (unsigned int s = begin; s < end; s++)
     {
-        contact->SetEnabled(false);
-        return;
-    }
+        Scene *scene = (*step->mScenes)[s];
+        Scene::Binding binding(scene); // Contacts may create objects, which belong in this scene
 
-    objectA->onPreSolve(objectB, contact, oldManifold);
-    objectB->onPreSolve(objectA, contact, oldManifold);
+        TRACE_SCOPE("b2World::Step");
+        scene->getWorld()->Step(step->mDeltaTime, 8, 3);
+    }
 }
 
-void PhysicsManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+bool PhysicsManager::update(float dt)
 {
-}
+    WorldStep step;
+    step.mScenes = &SceneManager::get()->getScenes();
+    step.mDeltaTime = dt;
 
-void PhysicsManager::BeginContact(b2Contact* contact)
-{
-    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
-    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+    if (JobSystem::get())
+        JobSystem::get()->parallelFor(step.mScenes->size(), 1, stepWorldJob, &step);
+    else
+        stepWorldJob(&step, 0, step.mScenes->size());
 
-    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
-        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
-    {
-        contact->SetEnabled(false);
-        return;
-    }
+    mTime++;
 
-    objectA->onContactBegin(objectB);
-    objectB->onContactBegin(objectA);
+    return true;
 }
 
-void PhysicsManager::EndContact(b2Contact* contact)
+b2World *PhysicsManager::getWorld()
 {
-    GameObject *objectA = static_cast <GameObject*> (contact->GetFixtureA()->GetBody()->GetUserData()); //grab the first object
-    GameObject *objectB = static_cast <GameObject*> (contact->GetFixtureB()->GetBody()->GetUserData()); //grab the second object
+    return SceneManager::get()->getCurrentScene()->getWorld();
+}
 
-    if (objectA->getComponent<RigidBodyComponent>()->getCollisionGroup()&
-        objectB->getComponent<RigidBodyComponent>()->getCollisionGroup()) // These objects get to pass through each other
-    {
-        contact->SetEnabled(false);
-        return;
-    }
+b2Body *PhysicsManager::getGroundBody()
+{
+    return SceneManager::get()->getCurrentScene()->getGroundBody();
+}
 
-    objectA->onContactEnd(objectB);
-    objectB->onContactEnd(objectA);
+void PhysicsManager::setGroundBody(b2Body *body)
+{
+    SceneManager::get()->getCurrentScene()->setGroundBody(body);
 }
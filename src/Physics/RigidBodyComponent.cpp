@@ -4,7 +4,7 @@
 #include <fstream>
 #include <Core/Math.h>
 #include <Core/GameObject.h>
-#include <Physics/PhysicsManager.h>
+#include <Scene/Scene.h>
 #include <Rendering/RenderingManager.h>
 #include <Rendering/SpriteComponent.h>
 
@@ -14,6 +14,10 @@ RigidBodyComponent::RigidBodyComponent(GameObject *object, std::string name, std
     mBody = NULL;
     mTypeName = "RigidBodyComponent";
 
+    // Keep the body where the object is
+    subscribe(ComponentCallback::SET_POSITION);
+    subscribe(ComponentCallback::SET_ROTATION);
+
     if (bodyFile != "") // If a path wasn't specified, we don't want to try to load anything
     {
         //load the body file
@@ -32,7 +36,7 @@ RigidBodyComponent::RigidBodyComponent(GameObject *object, std::string name, std
         def.type = (b2BodyType)bodyType;
         def.fixedRotation = false;
 
-        mBody = PhysicsManager::get()->getWorld()->CreateBody(&def);
+        mBody = mGameObject->getScene()->getWorld()->CreateBody(&def);
         mBody->SetUserData(mGameObject); //set the user data to this component's object
 
         //get the fixture count
@@ -84,7 +88,7 @@ RigidBodyComponent::RigidBodyComponent(GameObject *object, std::string name, std
         b2BodyDef def;
         def.type = b2_dynamicBody;
 
-        mBody = PhysicsManager::get()->getWorld()->CreateBody(&def);
+        mBody = mGameObject->getScene()->getWorld()->CreateBody(&def);
         mBody->SetUserData(mGameObject); //set the user data to this component's object
 
         b2PolygonShape *shape = new b2PolygonShape;
@@ -107,13 +111,18 @@ RigidBodyComponent::RigidBodyComponent(GameObject *object, std::string name, b2B
     mBody = NULL;
     mTypeName = "RigidBodyComponent";
 
+    subscribe(ComponentCallback::SET_POSITION);
+    subscribe(ComponentCallback::SET_ROTATION);
+
     mBody = body;
-    mBody->SetUserData(mGameObject); //set the user data to this component's object
+    if (mBody) // Components made for deserialization get their body from the packet
+        mBody->SetUserData(mGameObject); //set the user data to this component's object
 }
 
 RigidBodyComponent::~RigidBodyComponent()
 {
-    PhysicsManager::get()->getWorld()->DestroyBody(mBody);
+    if (mBody) // The body knows its own world, whatever scene is current
+        mBody->GetWorld()->DestroyBody(mBody);
 }
 
 void RigidBodyComponent::serialize(sf::Packet &packet)
@@ -165,7 +174,7 @@ void RigidBodyComponent::serialize(sf::Packet &packet)
 void RigidBodyComponent::deserialize(sf::Packet &packet)
 {
     if (mBody)
-        PhysicsManager::get()->getWorld()->DestroyBody(mBody);
+        mBody->GetWorld()->DestroyBody(mBody);
 
     Component::deserialize(packet);
 
@@ -186,7 +195,7 @@ void RigidBodyComponent::deserialize(sf::Packet &packet)
     bodyDef.fixedRotation = fixedRotation;
     bodyDef.allowSleep = allowSleep;
 
-    mBody = PhysicsManager::get()->getWorld()->CreateBody(&bodyDef);
+    mBody = mGameObject->getScene()->getWorld()->CreateBody(&bodyDef);
     mBody->SetUserData(mGameObject); //set the user data to this object
 
     packet >> mCollisionGroup;
@@ -252,5 +261,6 @@ void RigidBodyComponent::onSetRotation(float rotation)
 
 Component *RigidBodyComponent::createComponent(GameObject *object)
 {
-    return new RigidBodyComponent(object, "body", "");
+    // No body yet - deserialize builds it, so don't build a throwaway one from the sprite
+    return object->createPooledComponent<RigidBodyComponent>("body", (b2Body*)NULL);
 }
@@ -23,6 +23,8 @@ enum
 
 PlayerControlComponent::PlayerControlComponent(GameObject *object, std::string name) : Component(object, name)
 {
+    mTypeName = "PlayerControlComponent";
+
     mOnGround = false; // Floating by default
     mContactCount = 0;
 
@@ -31,6 +33,10 @@ PlayerControlComponent::PlayerControlComponent(GameObject *object, std::string n
     mDirection = LEFT;
 
     mFollowers = 0; // No followers to begin with
+
+    // Contacts keep track of whether we're on the ground
+    subscribe(ComponentCallback::CONTACT_BEGIN);
+    subscribe(ComponentCallback::CONTACT_END);
 }
 
 PlayerControlComponent::~PlayerControlComponent()
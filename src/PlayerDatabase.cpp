@@ -5,14 +5,15 @@
 PlayerDatabase::PlayerDatabase()
 {
     mActivePlayers = 0;
+    mPlayerPrefab = NULL;
 }
 
 PlayerDatabase::~PlayerDatabase()
 {
-    //dtor
+    delete mPlayerPrefab;
 }
 
-bool PlayerDatabase::createPlayer(std::string name, std::string password, int networkID)
+bool PlayerDatabase::createPlayer(std::string name, std::string password, int networkID, Scene *scene)
 {
     // Make sure this player doesn't already exist
     Player *player = findPlayer(name);
@@ -24,6 +25,7 @@ bool PlayerDatabase::createPlayer(std::string name, std::string password, int ne
     player->mPassword = password;
     player->mNetworkID = networkID;
     player->mSpawnPosition = sf::Vector2f(0,5);
+    player->mScene = scene;
 
     // Create GameObject
     spawnPlayer(player);
@@ -35,7 +37,7 @@ bool PlayerDatabase::createPlayer(std::string name, std::string password, int ne
     return true;
 }
 
-void PlayerDatabase::playerLogin(std::string name, std::string password, int networkID)
+void PlayerDatabase::playerLogin(std::string name, std::string password, int networkID, Scene *scene)
 {
     Player *player = findPlayer(name);
 
@@ -44,6 +46,7 @@ void PlayerDatabase::playerLogin(std::string name, std::string password, int net
         if (player->mPassword == password)
         {
             player->mNetworkID = networkID;
+            player->mScene = scene;
 
             // Create GameObject
             spawnPlayer(player);
@@ -68,8 +71,11 @@ void PlayerDatabase::playerLogout(int networkID)
     if (player)
     {
         player->mNetworkID = -1;
-        player->mGameObject->kill();
-        player->mGameObject = NULL;
+        GameObject *object = GameObject::get(player->mGameObject);
+        if (object) // The object may already be gone
+            object->kill();
+        player->mGameObject = Handle();
+        player->mScene = NULL;
 
         mActivePlayers--;
     }
@@ -77,15 +83,29 @@ void PlayerDatabase::playerLogout(int networkID)
 
 void PlayerDatabase::spawnPlayer(Player *player)
 {
-    player->mGameObject = SceneManager::get()->createGameObject();
-    player->mGameObject->addComponent(new SpriteComponent(player->mGameObject, "sprite", "Content/Textures/averysprite.png", 36, 6));
-    player->mGameObject->addComponent(new RigidBodyComponent(player->mGameObject, "body", "Content/beingBody.txt"));
-    player->mGameObject->addComponent(new HeroControlComponent(player->mGameObject, "control", player->mNetworkID));
-    player->mGameObject->addComponent(new DragComponent(player->mGameObject, "drag"));
-    player->mGameObject->setPosition(player->mSpawnPosition);
-    player->mGameObject->getComponent<SpriteComponent>()->setAnimDelay(100);
-    player->mGameObject->getComponent<RigidBodyComponent>()->getBody()->SetFixedRotation(true);
-    player->mGameObject->getComponent<RigidBodyComponent>()->setCollisionGroup(1);
+    if (!mPlayerPrefab)
+        createPlayerPrefab(player->mScene);
+
+    GameObject *object = mPlayerPrefab->instantiate(player->mScene, player->mSpawnPosition);
+    object->addComponent(new HeroControlComponent(object, "control", player->mNetworkID));
+
+    player->mGameObject = object->getHandle();
+}
+
+void PlayerDatabase::createPlayerPrefab(Scene *scene)
+{
+    // The template never joins the scene. The body file is only read here
+    GameObject *object = GameObject::create();
+    object->setScene(scene);
+    object->addPooledComponent<SpriteComponent>("sprite", "Content/Textures/averysprite.png", 36, 6);
+    object->addPooledComponent<RigidBodyComponent>("body", "Content/beingBody.txt");
+    object->addComponent(new DragComponent(object, "drag"));
+    object->getComponent<SpriteComponent>()->setAnimDelay(100);
+    object->getComponent<RigidBodyComponent>()->getBody()->SetFixedRotation(true);
+    object->getComponent<RigidBodyComponent>()->setCollisionGroup(1);
+
+    mPlayerPrefab = new Prefab(object);
+    object->release();
 }
 
 Player *PlayerDatabase::findPlayer(std::string name)
@@ -1,13 +1,31 @@
 #include "Rendering/GlowingShapeComponent.h"
 
 #include <SFML/Graphics.hpp>
+#ifndef FISSION_HEADLESS
+#include <LTBL/Light/EmissiveLight.h>
+#include <LTBL/Light/LightSystem.h>
+#endif
 #include <Core/ResourceManager.h>
 #include <Core/GameObject.h>
 #include <Rendering/RenderingManager.h>
+#include <Scene/Scene.h>
 
 GlowingShapeComponent::GlowingShapeComponent(GameObject *object, std::string name, std::string shapeFile, sf::Vector2f scale, bool castShadow, bool lit) :
     ShapeComponent(object, name, shapeFile, castShadow, lit)
 {
+    mTypeName = "GlowingShapeComponent";
+
+    mAlpha = 1.1f;
+    mAlphaDir = -1.f;
+
+    // The glow is drawn with shaders into render textures, which need GL
+    mTexture = NULL;
+    mEmissiveLight = NULL;
+    #ifndef FISSION_HEADLESS
+    ltbl::LightSystem *lightSystem = mGameObject->getScene() ? mGameObject->getScene()->getLightSystem() : NULL;
+    if (!lightSystem)
+        return;
+
     // Our blur shader
     sf::Shader blurShader;
 
@@ -48,16 +66,16 @@ GlowingShapeComponent::GlowingShapeComponent(GameObject *object, std::string nam
 
     mEmissiveLight->m_intensity = 1.1f;
 
-    RenderingManager::get()->getLightSystem()->AddEmissiveLight(mEmissiveLight);
-
-    mAlpha = 1.1f;
-    mAlphaDir = -1.f;
+    lightSystem->AddEmissiveLight(mEmissiveLight);
+    #endif
 }
 
 GlowingShapeComponent::~GlowingShapeComponent()
 {
+    #ifndef FISSION_HEADLESS
     delete mTexture;
     delete mEmissiveLight;
+    #endif
 }
 
 bool GlowingShapeComponent::update(float dt)
@@ -69,30 +87,38 @@ bool GlowingShapeComponent::update(float dt)
     else if (mAlpha >= 1)
         mAlphaDir = -1.1f;
 
-    mEmissiveLight->m_color = Color3f(mAlpha, mAlpha, mAlpha);
+    #ifndef FISSION_HEADLESS
+    if (mEmissiveLight)
+        mEmissiveLight->m_color = Color3f(mAlpha, mAlpha, mAlpha);
+    #endif
 
     return true;
 }
 
 void GlowingShapeComponent::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
+    #ifndef FISSION_HEADLESS
     sf::Vector2u screenSize = target->getSize();
 
-    sf::Vector2f newPos = (mGameObject->getPosition()*RenderingManager::get()->getPTU());
+    float alpha = RenderingManager::get()->getInterpolation();
+    float rotation = mGameObject->getRenderRotation(alpha);
+
+    sf::Vector2f newPos = (mGameObject->getRenderPosition(alpha)*RenderingManager::get()->getPTU());
     newPos.y *= -1;
     newPos += RenderingManager::get()->getCameraScreenOffset();
 
     Vec2f center(mCenter.x, mCenter.y);
-    center.RotateBy(-mGameObject->getRotation());
+    center.RotateBy(-rotation);
     Vec2f lightPos = Vec2f(newPos.x, newPos.y)-(center*RenderingManager::get()->getPTU());
 
     mEmissiveLight->SetCenter(Vec2f(lightPos.x, screenSize.y-lightPos.y));
-    mEmissiveLight->SetRotation(mGameObject->getRotation());
+    mEmissiveLight->SetRotation(rotation);
 
     if (mLightHull)
     {
         mLightHull->SetWorldCenter(Vec2f(newPos.x, screenSize.y-newPos.y));
-        if (mLightHull->GetRotation() != mGameObject->getRotation())
-            mLightHull->SetRotation(mGameObject->getRotation());
+        if (mLightHull->GetRotation() != rotation)
+            mLightHull->SetRotation(rotation);
     }
+    #endif
 }
@@ -1,11 +1,30 @@
 #include "Rendering/RenderingManager.h"
 
+#ifndef FISSION_HEADLESS
+#include <LTBL/Light/LightSystem.h>
+#endif
+
+#include "Core/Tracer.h"
+
 RenderingManager *RenderingManager::Instance = NULL;
 
-RenderingManager::RenderingManager()
+RenderingManager::RenderingManager(bool headless)
 {
     Instance = this;
 
+    mHeadless = headless;
+    mPTU = 32.f; //32 pixels per unit
+    mInterpolation = 1.f;
+
+    mRenderWindow = NULL;
+    mLightSystem = NULL;
+
+    #ifdef FISSION_HEADLESS
+    mHeadless = true; // There's no window or light system in this build to make
+    #else
+    if (mHeadless)
+        return;
+
     // Create the window
     mRenderWindow = new sf::RenderWindow(sf::VideoMode(800,600,32), "Test");
 
@@ -13,39 +32,83 @@ RenderingManager::RenderingManager()
     mLightSystem = new ltbl::LightSystem(AABB(Vec2f(0.0f, 0.0f), Vec2f(mRenderWindow->getSize().x, mRenderWindow->getSize().y)),
                                          mRenderWindow, "Content/Textures/lightFin.png", "Content/Shaders/lightAttenuationShader.frag");
     mLightSystem->m_useBloom = true;
-
-    mPTU = 32.f; //32 pixels per unit
+    #endif
 }
 
 RenderingManager::~RenderingManager()
 {
-    mRenderWindow->close();
+    #ifndef FISSION_HEADLESS
+    if (mRenderWindow)
+        mRenderWindow->close();
     delete mLightSystem;
     delete mRenderWindow;
+    #endif
 }
 
 bool RenderingManager::update(float dt)
 {
-    return mRenderWindow->isOpen();
+    // Runs at the end of every tick
+    mPreviousCameraPosition = mTickCameraPosition;
+    mTickCameraPosition = mCameraPosition;
+
+    #ifdef FISSION_HEADLESS
+    return true;
+    #else
+    return mHeadless || mRenderWindow->isOpen();
+    #endif
 }
 
+// A headless game never renders, so the headless build leaves the drawing out
+
 void RenderingManager::beginRender()
 {
+    #ifndef FISSION_HEADLESS
     mRenderWindow->clear(); //clear the window
 
     mLightSystem->SetView(mRenderWindow->getView());
+    #endif
 }
 
 void RenderingManager::renderLights()
 {
+    #ifndef FISSION_HEADLESS
     //calculate the lights
-    mLightSystem->RenderLights();
+    {
+        TRACE_SCOPE("ltbl::LightSystem::RenderLights");
+        mLightSystem->RenderLights();
+    }
 
     //draw the lights
     mLightSystem->RenderLightTexture();
+    #endif
 }
 
 void RenderingManager::endRender()
 {
+    #ifndef FISSION_HEADLESS
     mRenderWindow->display(); //display the window
+    #endif
+}
+
+sf::Vector2f RenderingManager::getScreenSize()
+{
+    #ifndef FISSION_HEADLESS
+    if (mRenderWindow)
+        return sf::Vector2f(mRenderWindow->getSize().x, mRenderWindow->getSize().y);
+    #endif
+
+    return sf::Vector2f();
+}
+
+sf::Vector2f RenderingManager::getCameraScreenOffset()
+{
+    sf::Vector2f camera = getRenderCameraPosition();
+    sf::Vector2f offset = sf::Vector2f(-camera.x, camera.y)*mPTU;
+
+    #ifndef FISSION_HEADLESS
+    if (mRenderWindow)
+        offset += mRenderWindow->getView().getSize()/2.f;
+    #endif
+
+    return offset;
 }
@@ -1,15 +1,25 @@
 #include "Rendering/ShapeComponent.h"
 
 #include <fstream>
+#ifndef FISSION_HEADLESS
+#include <LTBL/Light/ConvexHull.h>
+#include <LTBL/Light/LightSystem.h>
+#endif
 #include <Core/Math.h>
 #include <Core/GameObject.h>
 #include <Rendering/RenderingManager.h>
+#include <Scene/Scene.h>
 
 ShapeComponent::ShapeComponent(GameObject *object, std::string name, std::string shapeFile, bool castShadow, bool lit) : Component(object, name)
 {
-    mShape = new sf::ConvexShape; //allocate the shape
+    mTypeName = "ShapeComponent";
+
+    mShape = NULL;
     mLightHull = NULL;
 
+    #ifndef FISSION_HEADLESS // Shapes are only drawn, so the headless build doesn't load them
+    mShape = new sf::ConvexShape; //allocate the shape
+
     mShape->setFillColor(sf::Color(255,0,0));
 
     //load the shape
@@ -39,7 +49,9 @@ ShapeComponent::ShapeComponent(GameObject *object, std::string name, std::string
 
     file.close();
 
-    if (castShadow)
+    // No shadows to cast when headless, or in scenes that aren't drawn
+    ltbl::LightSystem *lightSystem = mGameObject->getScene() ? mGameObject->getScene()->getLightSystem() : NULL;
+    if (castShadow && lightSystem)
     {
         // Create a hull by loading it from a file
         mLightHull = new ltbl::ConvexHull();
@@ -53,13 +65,16 @@ ShapeComponent::ShapeComponent(GameObject *object, std::string name, std::string
 
         mLightHull->m_renderLightOverHull = lit;
 
-        RenderingManager::get()->getLightSystem()->AddConvexHull(mLightHull);
+        lightSystem->AddConvexHull(mLightHull);
     }
+    #endif
 }
 
 ShapeComponent::~ShapeComponent()
 {
+    #ifndef FISSION_HEADLESS
     delete mShape;
+    #endif
 }
 
 bool ShapeComponent::update(float dt)
@@ -69,21 +84,26 @@ bool ShapeComponent::update(float dt)
 
 void ShapeComponent::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
+    #ifndef FISSION_HEADLESS
     sf::Vector2u screenSize = target->getSize();
 
-    sf::Vector2f newPos = (mGameObject->getPosition()*RenderingManager::get()->getPTU());
+    float alpha = RenderingManager::get()->getInterpolation();
+    float rotation = mGameObject->getRenderRotation(alpha);
+
+    sf::Vector2f newPos = (mGameObject->getRenderPosition(alpha)*RenderingManager::get()->getPTU());
     newPos.y *= -1;
     newPos += RenderingManager::get()->getCameraScreenOffset();
 
     mShape->setPosition(newPos);
-    mShape->setRotation(-mGameObject->getRotation());
+    mShape->setRotation(-rotation);
 
     if (mLightHull)
     {
         mLightHull->SetWorldCenter(Vec2f(mShape->getPosition().x, screenSize.y-mShape->getPosition().y));
-        if (mLightHull->GetRotation() != mGameObject->getRotation())
-            mLightHull->SetRotation(mGameObject->getRotation());
+        if (mLightHull->GetRotation() != rotation)
+            mLightHull->SetRotation(rotation);
     }
 
     target->draw(*mShape, states);
+    #endif
 }
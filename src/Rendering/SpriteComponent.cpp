@@ -10,21 +10,18 @@
 SpriteComponent::SpriteComponent(GameObject *object, std::string name, std::string imgPath, int frames, int framesPerRow) : Component(object, name)
 {
     mTexturePath = imgPath;
+    mParallelSafe = true; // Animating only touches this sprite and its GameObject
+
+    // Set before loading, since components made for deserialization don't load anything
+    mSprite = NULL;
+    mRelativeRotation = 0;
+    mKillOnAnimFinish = false;
+    mTypeName = "SpriteComponent";
 
     if (mTexturePath == "") // If a path wasn't specified, we don't want to try to load anything
         return;
 
-    sf::Texture *texture = ResourceManager::get()->getTexture(mTexturePath);
-    if (texture)
-    {
-        texture->setRepeated(false);
-        mSprite = new sf::Sprite(*texture);
-    }
-    else
-    {
-        mSprite = NULL;
-        return;
-    }
+    setTexture(mTexturePath); // No sprite when headless, but the frames are still worked out below
 
     //base animation stuff
     mCurFrame = 0;
@@ -34,15 +31,10 @@ SpriteComponent::SpriteComponent(GameObject *object, std::string name, std::stri
     mFrames = frames;
     mFramesPerRow = framesPerRow;
 
-    mFrameDim = sf::Vector2i(texture->getSize().x/mFramesPerRow, texture->getSize().y/(mFrames/mFramesPerRow));
+    sf::Vector2u imageSize = ResourceManager::get()->getImageSize(mTexturePath);
+    mFrameDim = sf::Vector2i(imageSize.x/mFramesPerRow, imageSize.y/(mFrames/mFramesPerRow));
     mStartFrame = 0;
     mEndFrame = mFrames-1;
-
-    mRelativeRotation = 0;
-
-    mKillOnAnimFinish = false;
-
-    mTypeName = "SpriteComponent";
 }
 
 SpriteComponent::~SpriteComponent()
@@ -63,17 +55,7 @@ void SpriteComponent::deserialize(sf::Packet &packet)
     Component::deserialize(packet);
 
     packet >> mTexturePath;
-    sf::Texture *texture = ResourceManager::get()->getTexture(mTexturePath);
-    if (texture)
-    {
-        texture->setRepeated(false);
-        mSprite = new sf::Sprite(*texture);
-    }
-    else
-    {
-        mSprite = NULL;
-        return;
-    }
+    setTexture(mTexturePath);
 
     //base animation stuff
     packet >> mCurFrame >> mFrameDir >> mAnimDelay;
@@ -84,7 +66,8 @@ void SpriteComponent::deserialize(sf::Packet &packet)
 
     packet >> mFrames >> mFramesPerRow;
 
-    mFrameDim = sf::Vector2i(texture->getSize().x/mFramesPerRow, texture->getSize().y/(mFrames/mFramesPerRow));
+    sf::Vector2u imageSize = ResourceManager::get()->getImageSize(mTexturePath);
+    mFrameDim = sf::Vector2i(imageSize.x/mFramesPerRow, imageSize.y/(mFrames/mFramesPerRow));
     mStartFrame = 0;
     mEndFrame = mFrames-1;
 
@@ -116,6 +99,7 @@ bool SpriteComponent::update(float dt)
 
 void SpriteComponent::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
+    #ifndef FISSION_HEADLESS
     //invalid frame - don't render
     if (!mSprite || mCurFrame < mStartFrame || mCurFrame > mEndFrame)
         return;
@@ -126,24 +110,29 @@ void SpriteComponent::onRender(sf::RenderTarget *target, sf::RenderStates states
 
     mSprite->setTextureRect(sf::IntRect(frameX, frameY, mFrameDim.x, mFrameDim.y));
 
-    //calculate pixel position from GameObject position
-    sf::Vector2f newPos = ((mGameObject->getPosition()+mRelativePosition)*RenderingManager::get()->getPTU());
+    //calculate pixel position from where the GameObject is between the last two ticks
+    float alpha = RenderingManager::get()->getInterpolation();
+    sf::Vector2f newPos = mGameObject->getRenderTransform(alpha).transformPoint(mRelativePosition)*RenderingManager::get()->getPTU();
     newPos.y *= -1;
     newPos += RenderingManager::get()->getCameraScreenOffset();
 
     mSprite->setOrigin(sf::Vector2f(mFrameDim.x/2, mFrameDim.y/2));
     mSprite->setPosition(newPos);
-    mSprite->setRotation(-mGameObject->getRotation()-mRelativeRotation);
+    mSprite->setRotation(-mGameObject->getRenderRotation(alpha)-mRelativeRotation);
     target->draw(*mSprite, states); //rendahhh!!!!
+    #endif
 }
 
 Component *SpriteComponent::createComponent(GameObject *object)
 {
-    return new SpriteComponent(object, "sprite", "", 1, 1);
+    return object->createPooledComponent<SpriteComponent>("sprite", "", 1, 1);
 }
 
 void SpriteComponent::setTexture(sf::Texture *texture)
 {
+    #ifdef FISSION_HEADLESS
+    mSprite = NULL; // Frame sizes come from ResourceManager::getImageSize, so only the sprite is left out
+    #else
     if (mSprite)
         delete mSprite;
 
@@ -154,6 +143,7 @@ void SpriteComponent::setTexture(sf::Texture *texture)
     }
     else
         mSprite = NULL;
+    #endif
 }
 
 void SpriteComponent::setTexture(std::string path)
@@ -0,0 +1,57 @@
+/*
+Prefab.cpp
+Theodore DeRego
+Copyright 2012
+
+Prefab implementation
+*/
+
+#include "Scene/Prefab.h"
+
+#include <iostream>
+
+#include "Core/GameObject.h"
+
+Prefab::Prefab(GameObject *object)
+{
+    std::vector <Component*> &components = object->getComponents();
+    for (unsigned int c = 0; c < components.size(); c++)
+    {
+        if (!components[c]->getShouldSerialize())
+            continue;
+
+        // Resolve the type name now so instances never have to
+        ComponentCreationFunction function = SceneManager::get()->getComponentCreationFunction(components[c]->getTypeName());
+        if (!function)
+        {
+            std::cout << "Error: " << components[c]->getTypeName().getString() << " has no creation function and can't be baked into a prefab\n";
+            continue;
+        }
+
+        mCreationFunctions.push_back(function);
+        components[c]->serialize(mData);
+    }
+}
+
+Prefab::~Prefab()
+{
+    //dtor
+}
+
+GameObject *Prefab::instantiate(Scene *scene, sf::Vector2f position, float rotation)
+{
+    GameObject *object = SceneManager::get()->createGameObject(scene);
+
+    mData.reset(); // Read the blob from the start again
+    for (unsigned int c = 0; c < mCreationFunctions.size(); c++)
+    {
+        Component *component = mCreationFunctions[c](object);
+        component->deserialize(mData);
+        object->addComponent(component);
+    }
+
+    object->setPosition(position);
+    object->setRotation(rotation);
+
+    return object;
+}
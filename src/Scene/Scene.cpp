@@ -1,19 +1,67 @@
 #include "Scene/Scene.h"
 
+#include <algorithm>
+
 #include "Core/GameObject.h"
+#include "Core/JobSystem.h"
+#include "Core/Tracer.h"
 #include "Rendering/RenderingManager.h"
 #include "Scene/SceneManager.h"
+#include "Physics/PhysicsManager.h"
 #include "Physics/RigidBodyComponent.h"
 
+thread_local Scene *Scene::Bound = NULL;
+
+/// Everything a worker needs to update a range of objects
+struct ParallelUpdate
+{
+    Scene *mScene;
+    std::vector <GameObject*> *mGameObjects;
+    float mDeltaTime;
+};
+
+static void updateParallelJob(void *data, unsigned int begin, unsigned int end)
+{
+    ParallelUpdate *update = (ParallelUpdate*)data;
+    Scene::Binding binding(update->mScene); // Workers may be helping out with some other scene
+
+    for (unsigned int o = begin; o < end; o++)
+    {
+        GameObject *object = (*update->mGameObjects)[o];
+        if (object->getAlive() && object->getUpdateDue())
+            object->updateParallel(object->getUpdateTime());
+    }
+}
+
 Scene::Scene()
 {
-    //ctor
+    mActiveRadius = 40.f;
+    mDormantRadius = 120.f;
+    mIdleInterval = 8;
+
+    mBudgetReportInterval = 0;
+    mTicksSinceReport = 0;
+
+    mWorld = new b2World(b2Vec2(0, -10)); //gravity = 10
+    mWorld->SetContactListener(&mContactListener);
+    mGroundBody = NULL;
+
+    mDragger = NULL;
+    mLightSystem = NULL;
 }
 
 Scene::~Scene()
 {
     //clear the scene
-    clear();
+    {
+        Binding binding(this); // Components being destroyed clean up after themselves in this scene
+        clear();
+    }
+
+    for (unsigned int p = 0; p < mPools.size(); p++)
+        delete mPools[p];
+
+    delete mWorld;
 }
 
 void Scene::initialize()
@@ -22,24 +70,186 @@ void Scene::initialize()
 
 bool Scene::update(float deltaTime)
 {
+    Binding binding(this); // Anything made or looked up while updating belongs to this scene
+
+    // Decide who updates this tick before anything updates
+    mUpdateScheduler.beginTick(deltaTime);
+    resolveWorldTransforms();
+    scheduleUpdates(deltaTime);
+
+    // Update the pooled components one type at a time before the rest of the objects
+    updatePools(deltaTime);
+
+    // Spread the parallel safe components across the cores, then update everything else here. The pools may have
+    // moved things
+    resolveWorldTransforms();
+
+    ParallelUpdate parallelUpdate;
+    parallelUpdate.mScene = this;
+    parallelUpdate.mGameObjects = &mGameObjects;
+    parallelUpdate.mDeltaTime = deltaTime;
+
+    if (JobSystem::get())
+        JobSystem::get()->parallelFor(mGameObjects.size(), 64, updateParallelJob, &parallelUpdate);
+    else
+        updateParallelJob(&parallelUpdate, 0, mGameObjects.size());
+
     for (unsigned int o = 0; o < mGameObjects.size(); o++)
     {
-        if (!mGameObjects[o]->getAlive() || !mGameObjects[o]->update(deltaTime)) //update the game object
+        if (mGameObjects[o]->getAlive() && mGameObjects[o]->getUpdateDue() &&
+            !mGameObjects[o]->update(mGameObjects[o]->getUpdateTime())) //update the game object
+            mGameObjects[o]->kill();
+    }
+
+    mUpdateScheduler.endTick();
+
+    if (mBudgetReportInterval > 0 && ++mTicksSinceReport >= mBudgetReportInterval)
+    {
+        mTicksSinceReport = 0;
+        mUpdateScheduler.printReport();
+    }
+
+    // Nothing is removed while objects are updating, so objects killed this tick all go here
+    destroyDeadGameObjects();
+
+    return true;
+}
+
+void Scene::scheduleUpdates(float deltaTime)
+{
+    TRACE_SCOPE("Scene::scheduleUpdates");
+
+    mActivityAnchors.clear();
+    // The camera looks at the main scene, so it only keeps objects there active
+    if (RenderingManager::get() && SceneManager::get() && SceneManager::get()->getMainScene() == this)
+        mActivityAnchors.push_back(RenderingManager::get()->getCameraPosition());
+    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    {
+        if (mGameObjects[o]->getActivityAnchor())
+            mActivityAnchors.push_back(mGameObjects[o]->getWorldPosition());
+    }
+
+    float activeRadiusSq = mActiveRadius*mActiveRadius;
+    float dormantRadiusSq = mDormantRadius*mDormantRadius;
+
+    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    {
+        GameObject *object = mGameObjects[o];
+        if (!object->getAlive())
+            continue;
+
+        // Nothing has moved yet this tick, so this is where rendering blends from
+        object->storePreviousTransform();
+
+        if (object->getAlwaysActive() || object->getActivityAnchor() || object->getWakeRequested())
+        {
+            object->scheduleUpdate(ActivityTier::ACTIVE, deltaTime, mIdleInterval);
+            continue;
+        }
+
+        // Bodies Box2D is still simulating have to stay in sync with their object
+        RigidBodyComponent *body = object->getComponent<RigidBodyComponent>();
+        if (body && body->getBody() && body->getBody()->GetType() != b2_staticBody && body->getBody()->IsAwake())
         {
-            mGameObjects[o]->release(); //release the GameObject
-            mGameObjects.erase(mGameObjects.begin()+o);
-            o--; //don't skip an object
+            object->scheduleUpdate(ActivityTier::ACTIVE, deltaTime, mIdleInterval);
+            continue;
         }
+
+        // Everything else goes by how close the nearest anchor is
+        sf::Vector2f position = object->getWorldPosition();
+        float nearestSq = dormantRadiusSq+1.f;
+        for (unsigned int a = 0; a < mActivityAnchors.size(); a++)
+        {
+            sf::Vector2f offset = mActivityAnchors[a]-position;
+            float distanceSq = offset.x*offset.x+offset.y*offset.y;
+            if (distanceSq < nearestSq)
+                nearestSq = distanceSq;
+        }
+
+        if (nearestSq <= activeRadiusSq)
+            object->scheduleUpdate(ActivityTier::ACTIVE, deltaTime, mIdleInterval);
+        else if (nearestSq <= dormantRadiusSq)
+            object->scheduleUpdate(ActivityTier::IDLE, deltaTime, mIdleInterval);
+        else
+            object->scheduleUpdate(ActivityTier::DORMANT, deltaTime, mIdleInterval);
     }
+}
 
-    return true;
+void Scene::updatePools(float deltaTime)
+{
+    TRACE_SCOPE("Scene::updatePools");
+
+    for (unsigned int p = 0; p < mPools.size(); p++)
+    {
+        if (!mPools[p])
+            continue;
+
+        // The serial part of the pool before may have moved things
+        resolveWorldTransforms();
+        mPools[p]->updateAll(deltaTime);
+    }
+}
+
+void Scene::resolveWorldTransforms()
+{
+    TRACE_SCOPE("Scene::resolveWorldTransforms");
+
+    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+        mGameObjects[o]->getWorldTransform(); // Parents are built along the way
+}
+
+ComponentPoolBase *Scene::getPool(unsigned int typeID, PoolFactory factory)
+{
+    if (typeID >= mPools.size())
+        mPools.resize(typeID+1, NULL);
+
+    if (!mPools[typeID])
+        mPools[typeID] = factory(this);
+
+    return mPools[typeID];
+}
+
+void Scene::destroyDeadGameObjects()
+{
+    TRACE_SCOPE("Scene::destroyDeadGameObjects");
+
+    // Move the survivors to the front, keeping their order
+    unsigned int alive = 0;
+    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    {
+        if (mGameObjects[o]->getAlive())
+            mGameObjects[alive++] = mGameObjects[o];
+        else
+            mDestroyQueue.push_back(mGameObjects[o]);
+    }
+    mGameObjects.resize(alive);
+
+    // Callbacks may kill or create other objects, which are handled next tick
+    for (unsigned int o = 0; o < mDestroyQueue.size(); o++)
+    {
+        mDestroyQueue[o]->onDestroy();
+
+        for (unsigned int c = 0; c < mDestructionCallbacks.size(); c++)
+            mDestructionCallbacks[c](mDestroyQueue[o]);
+    }
+
+    for (unsigned int o = 0; o < mDestroyQueue.size(); o++)
+    {
+        unindexGameObject(mDestroyQueue[o], mDestroyQueue[o]->getID());
+        if (mDestroyQueue[o]->getAllocatedID()) // IDs from the server can match ones this scene handed out
+            mIDAllocator.free(mDestroyQueue[o]->getID());
+        mDestroyQueue[o]->setScene(NULL);
+        mDestroyQueue[o]->release(); //release the GameObject
+    }
+    mDestroyQueue.clear();
 }
 
 void Scene::onRender(sf::RenderTarget *target, sf::RenderStates states)
 {
     for (unsigned int o = 0; o < mGameObjects.size(); o++)
     {
-        mGameObjects[o]->onRender(target, states);
+        if (mGameObjects[o]->getAlive()) // Dead objects are waiting to be removed
+            mGameObjects[o]->onRender(target, states);
     }
 }
 
@@ -63,6 +273,8 @@ void Scene::serializeCreationPacket(sf::Packet &packet)
 
 void Scene::deserializeCreationPacket(sf::Packet &packet)
 {
+    Binding binding(this); // Create the objects here, whatever scene the caller is working on
+
     int objectCount;
     packet >> objectCount;
 
@@ -72,69 +284,243 @@ void Scene::deserializeCreationPacket(sf::Packet &packet)
     }
 }
 
-void Scene::serializeUpdatePacket(sf::Packet &packet)
+sf::Uint32 Scene::takeSnapshot()
 {
-    // Get networked object count
-    int objectCount = 0;
+    Snapshot snapshot;
     for (unsigned int o = 0; o < mGameObjects.size(); o++)
     {
-        if (mGameObjects[o]->getSyncNetwork())
-            objectCount++;
+        GameObject *object = mGameObjects[o];
+        if (!object->getSyncNetwork() || object->getID() < 0)
+            continue;
+
+        ObjectState state;
+        state.mID = object->getID();
+        state.mFields[SnapshotField::POSITION_X] = object->getPosition().x;
+        state.mFields[SnapshotField::POSITION_Y] = object->getPosition().y;
+        state.mFields[SnapshotField::ROTATION] = object->getRotation();
+
+        RigidBodyComponent *body = object->getComponent<RigidBodyComponent>();
+        if (body && body->getBody()) // Created components don't have a body until they're set up
+        {
+            state.mFields[SnapshotField::VELOCITY_X] = body->getBody()->GetLinearVelocity().x;
+            state.mFields[SnapshotField::VELOCITY_Y] = body->getBody()->GetLinearVelocity().y;
+            state.mFields[SnapshotField::ANGULAR_VELOCITY] = body->getBody()->GetAngularVelocity();
+        }
+
+        // Kept the way the client will see it, so movement too small to survive quantization isn't a change
+        state.quantize();
+
+        snapshot.mObjects.push_back(state);
     }
+    snapshot.sort();
 
-    packet << objectCount;
-    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    // A scene where nothing moves keeps its last snapshot, so clients that acknowledged it are sent nothing
+    const Snapshot &latest = mSnapshots.getLatest();
+    if (snapshot.matches(latest))
+        return latest.mSequence;
+
+    snapshot.mSequence = SnapshotHistory::allocateSequence();
+    mSnapshots.add(snapshot);
+
+    mInterestGrid.clear();
+    for (unsigned int o = 0; o < snapshot.mObjects.size(); o++)
     {
-        if (mGameObjects[o]->getSyncNetwork())
-        {
-            RigidBodyComponent *body = mGameObjects[o]->getComponent<RigidBodyComponent>();
+        ObjectState &state = snapshot.mObjects[o];
+        mInterestGrid.insert(o, sf::Vector2f(state.mFields[SnapshotField::POSITION_X], state.mFields[SnapshotField::POSITION_Y]));
+    }
+    mInterestGrid.build();
+
+    return snapshot.mSequence;
+}
 
-            packet << mGameObjects[o]->getID();
-            packet << mGameObjects[o]->getPosition().x << mGameObjects[o]->getPosition().y << mGameObjects[o]->getRotation();
+void Scene::getInterestSnapshot(sf::Vector2f center, float radius, float leaveRadius, const Snapshot *previous, Snapshot &interest)
+{
+    const Snapshot &latest = mSnapshots.getLatest();
 
-            if (body)
-                packet << body->getBody()->GetLinearVelocity().x << body->getBody()->GetLinearVelocity().y
-                       << body->getBody()->GetAngularVelocity();
-        }
+    std::vector <unsigned int> nearby;
+    mInterestGrid.query(center, leaveRadius > radius ? leaveRadius : radius, nearby);
+    std::sort(nearby.begin(), nearby.end()); // The snapshot's in ID order, so this puts the interest in ID order too
+
+    interest.mSequence = latest.mSequence;
+    interest.mObjects.clear();
+
+    float radiusSq = radius*radius;
+    for (unsigned int n = 0; n < nearby.size(); n++)
+    {
+        const ObjectState &state = latest.mObjects[nearby[n]];
+        sf::Vector2f offset = sf::Vector2f(state.mFields[SnapshotField::POSITION_X], state.mFields[SnapshotField::POSITION_Y])-center;
+
+        if (offset.x*offset.x+offset.y*offset.y <= radiusSq || (previous && previous->findObject(state.mID)))
+            interest.mObjects.push_back(state);
     }
 }
 
-void Scene::addGameObject(GameObject *object)
+void Scene::serializeUpdatePacket(sf::Packet &packet, sf::Uint32 baseline)
 {
-    mGameObjects.push_back(object);
+    const Snapshot *baselineSnapshot = mSnapshots.find(baseline);
+    if (!baselineSnapshot) // Too old. Start the client over from nothing
+        baselineSnapshot = mSnapshots.find(0);
+
+    serializeUpdatePacket(packet, mSnapshots.getLatest(), baselineSnapshot);
 }
 
+void Scene::serializeUpdatePacket(sf::Packet &packet, const Snapshot &snapshot, const Snapshot *baseline)
+{
+    sf::Uint32 baselineSequence = baseline ? baseline->mSequence : 0;
 
-void Scene::destroyGameObject(GameObject *object)
+    // The baseline is usually only a few snapshots back, so it's sent as the distance back
+    BitWriter writer;
+    writer.write(snapshot.mSequence, 32);
+    writer.writeVariable(snapshot.mSequence-baselineSequence);
+    snapshot.serializeDelta(writer, baseline);
+    writer.flush(packet);
+}
+
+sf::Uint32 Scene::deserializeUpdatePacket(sf::Packet &packet)
 {
-    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    Binding binding(this);
+
+    BitReader reader(packet);
+    sf::Uint32 sequence = reader.read(32);
+    sf::Uint32 baseline = sequence-reader.readVariable();
+    if (!reader.getValid())
+        return 0;
+
+    if (sequence == getSnapshotSequence()) // Sent again because the ack got lost, so acknowledge it again
+        return sequence;
+    if (sequence < getSnapshotSequence()) // Unreliable packets can arrive out of order
+        return 0;
+
+    const Snapshot *baselineSnapshot = mSnapshots.find(baseline);
+    if (!baselineSnapshot)
+        return 0;
+
+    Snapshot snapshot;
+    snapshot.mSequence = sequence;
+    if (!snapshot.deserializeDelta(reader, baselineSnapshot))
+        return 0;
+
+    // The baseline can be older than what was applied last, so what to apply is worked out against that. Only what
+    // changed is applied, so objects the server isn't moving are left asleep
+    const Snapshot &previous = mSnapshots.getLatest();
+    std::vector <unsigned int> changed;
+    std::vector <int> left;
+    snapshot.diff(&previous, changed, left);
+
+    for (unsigned int c = 0; c < changed.size(); c++)
     {
-        if (mGameObjects[o] == object) // Find the GameObject
+        const ObjectState &state = snapshot.mObjects[changed[c]];
+        GameObject *object = findGameObject(state.mID);
+        if (!object) // Not created here yet
+            continue;
+
+        object->setPosition(sf::Vector2f(state.mFields[SnapshotField::POSITION_X], state.mFields[SnapshotField::POSITION_Y]));
+        object->setRotation(state.mFields[SnapshotField::ROTATION]);
+
+        RigidBodyComponent *body = object->getComponent<RigidBodyComponent>();
+        if (body && body->getBody()) // Created components don't have a body until they're set up
         {
-            mGameObjects[o]->kill(); // Make sure it's dead
-            mGameObjects[o]->release(); // Release the GameObject
-            mGameObjects.erase(mGameObjects.begin()+o);
-            return;
+            body->getBody()->SetLinearVelocity(b2Vec2(state.mFields[SnapshotField::VELOCITY_X], state.mFields[SnapshotField::VELOCITY_Y]));
+            body->getBody()->SetAngularVelocity(state.mFields[SnapshotField::ANGULAR_VELOCITY]);
         }
+
+        // Objects the server started keeping this client up to date on
+        if (!previous.findObject(state.mID))
+            object->onNetworkEnter();
+    }
+
+    for (unsigned int l = 0; l < left.size(); l++)
+    {
+        GameObject *object = findGameObject(left[l]);
+        if (object)
+            object->onNetworkLeave();
     }
+
+    mSnapshots.add(snapshot);
+
+    return sequence;
+}
+
+void Scene::addGameObject(GameObject *object)
+{
+    mGameObjects.push_back(object);
+
+    object->setScene(this);
+    indexGameObject(object);
+}
+
+
+void Scene::destroyGameObject(GameObject *object)
+{
+    object->kill(); // It's removed with the rest of the dead at the end of the update
 }
 
 GameObject *Scene::findGameObject(int ID)
 {
-    for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    if (ID < 0)
+        return NULL; // Objects without an ID aren't indexed
+
+    unsigned int index = IDAllocator::getIndex(ID);
+    if (index < mIDIndex.size() && mIDIndex[index] && mIDIndex[index]->getID() == ID)
+        return mIDIndex[index];
+
+    return NULL; // Couldn't find it
+}
+
+void Scene::reindexGameObject(GameObject *object, int oldID)
+{
+    unindexGameObject(object, oldID);
+    indexGameObject(object);
+}
+
+void Scene::indexGameObject(GameObject *object)
+{
+    if (object->getID() < 0)
+        return;
+
+    unsigned int index = IDAllocator::getIndex(object->getID());
+    if (index >= mIDIndex.size())
+        mIDIndex.resize(index+1, NULL);
+
+    mIDIndex[index] = object;
+}
+
+void Scene::unindexGameObject(GameObject *object, int ID)
+{
+    if (ID < 0)
+        return;
+
+    unsigned int index = IDAllocator::getIndex(ID);
+    if (index < mIDIndex.size() && mIDIndex[index] == object) // Another object may have taken the index since
+        mIDIndex[index] = NULL;
+}
+
+void Scene::addDestructionCallback(DestructionCallback callback)
+{
+    mDestructionCallbacks.push_back(callback);
+}
+
+void Scene::removeDestructionCallback(DestructionCallback callback)
+{
+    for (unsigned int c = 0; c < mDestructionCallbacks.size(); c++)
     {
-        if (mGameObjects[o]->getID() == ID) //find the GameObject
+        if (mDestructionCallbacks[c] == callback)
         {
-            return mGameObjects[o];
+            mDestructionCallbacks.erase(mDestructionCallbacks.begin()+c);
+            return;
         }
     }
-
-    return NULL; // Couldn't find it
 }
 
 void Scene::clear()
 {
     for (unsigned int o = 0; o < mGameObjects.size(); o++)
+    {
+        unindexGameObject(mGameObjects[o], mGameObjects[o]->getID());
+        if (mGameObjects[o]->getAllocatedID()) // IDs from the server can match ones this scene handed out
+            mIDAllocator.free(mGameObjects[o]->getID());
+        mGameObjects[o]->setScene(NULL);
         mGameObjects[o]->release(); //release the GameObject
+    }
     mGameObjects.clear();
 }
@@ -5,6 +5,9 @@
 #include "Scene/SceneManager.h"
 #include "Scene/Scene.h"
 #include "Core/GameObject.h"
+#include "Core/JobSystem.h"
+#include "Core/Tracer.h"
+#include "Network/NetworkManager.h"
 
 #include "Rendering/SpriteComponent.h"
 #include "Physics/RigidBodyComponent.h"
@@ -13,17 +16,23 @@
 
 SceneManager *SceneManager::Instance = NULL;
 
+/// Only the authority hands out object IDs. Clients get theirs when the server's copy is deserialized
+static bool isAuthority()
+{
+    return !NetworkManager::get() || NetworkManager::get()->getType() == NetworkType::SERVER;
+}
+
 SceneManager::SceneManager()
 {
     Instance = this;
 
-    mCurrentScene = new Scene;
-    mScenes.push_back(mCurrentScene);
+    mMainScene = new Scene;
+    mScenes.push_back(mMainScene);
 
-    registerComponentCreationFunction("SpriteComponent", SpriteComponent::createComponent);
-    registerComponentCreationFunction("RigidBodyComponent", RigidBodyComponent::createComponent);
-    registerComponentCreationFunction("DragComponent", DragComponent::createComponent);
-    registerComponentCreationFunction("WeaponComponent", WeaponComponent::createComponent);
+    registerComponentType<SpriteComponent>("SpriteComponent");
+    registerComponentType<RigidBodyComponent>("RigidBodyComponent");
+    registerComponentType<DragComponent>("DragComponent");
+    registerComponentType<WeaponComponent>("WeaponComponent");
 }
 
 SceneManager::~SceneManager()
@@ -32,46 +41,143 @@ SceneManager::~SceneManager()
         delete mScenes[s];
 }
 
-bool SceneManager::update(float deltaTime)
+/// One scene's update, for handing to the JobSystem
+struct SceneUpdate
+{
+    Scene *mScene;
+    float mDeltaTime;
+    bool mResult;
+};
+
+static void updateSceneJob(void *data, unsigned int begin, unsigned int end)
 {
-    return mCurrentScene->update(deltaTime);
+    SceneUpdate *updates = (SceneUpdate*)data;
+
+    for (unsigned int s = begin; s < end; s++)
+    {
+        TRACE_SCOPE("Scene::update");
+        updates[s].mResult = updates[s].mScene->update(updates[s].mDeltaTime);
+    }
 }
 
-GameObject *SceneManager::createGameObject()
+bool SceneManager::update(float deltaTime)
 {
-    GameObject *object = new GameObject;
-    addGameObject(object);
-    return object;
+    if (mScenes.size() == 1)
+        return mMainScene->update(deltaTime);
+
+    std::vector <SceneUpdate> updates(mScenes.size());
+    for (unsigned int s = 0; s < mScenes.size(); s++)
+    {
+        updates[s].mScene = mScenes[s];
+        updates[s].mDeltaTime = deltaTime;
+        updates[s].mResult = true;
+    }
+
+    if (JobSystem::get())
+        JobSystem::get()->parallelFor(updates.size(), 1, updateSceneJob, &updates[0]);
+    else
+        updateSceneJob(&updates[0], 0, updates.size());
+
+    bool running = true;
+    for (unsigned int s = 0; s < updates.size(); s++)
+    {
+        if (!updates[s].mResult)
+            running = false;
+    }
+
+    return running;
 }
 
-void SceneManager::registerComponentCreationFunction(std::string name, ComponentCreationFunction funcPointer)
+Scene *SceneManager::createScene()
 {
-    mComponentCreationFunctionNames.push_back(name);
-    mComponentCreationFunctions.push_back(funcPointer);
+    Scene *scene = new Scene;
+    mScenes.push_back(scene);
+
+    return scene;
 }
 
-void SceneManager::removeComponentCreationFunction(std::string name)
+void SceneManager::destroyScene(Scene *scene)
 {
-    for (unsigned int f = 0; f < mComponentCreationFunctions.size(); f++)
+    if (scene == mMainScene) // The main scene lasts as long as the SceneManager
+        return;
+
+    for (unsigned int s = 0; s < mScenes.size(); s++)
     {
-        if (name == mComponentCreationFunctionNames[f])
+        if (mScenes[s] == scene)
         {
-            mComponentCreationFunctions.erase(mComponentCreationFunctions.begin()+f);
-            //mComponentCreationFunctionNames.erase(f);
-            return;
+            mScenes.erase(mScenes.begin()+s);
+            break;
         }
     }
+
+    if (NetworkManager::get())
+        NetworkManager::get()->moveConnectors(scene, mMainScene);
+
+    delete scene;
 }
 
-ComponentCreationFunction SceneManager::getComponentCreationFunction(std::string name)
+GameObject *SceneManager::createGameObject(Scene *scene)
 {
-    for (unsigned int f = 0; f < mComponentCreationFunctions.size(); f++)
+    if (!scene)
+        scene = getCurrentScene();
+
+    GameObject *object = GameObject::create();
+
+    if (isAuthority())
+        object->setID(scene->allocateID(), true);
+
+    scene->addGameObject(object);
+    return object;
+}
+
+void SceneManager::registerComponentType(Symbol name, ComponentCreationFunction funcPointer, unsigned int typeID,
+                                         unsigned int size, unsigned int alignment)
+{
+    ComponentTypeInfo type;
+    type.mName = name;
+    type.mCreationFunction = funcPointer;
+    type.mTypeID = typeID;
+    type.mSize = size;
+    type.mAlignment = alignment;
+
+    // Registering a name again replaces it, so it stops being found by its old type ID
+    removeComponentCreationFunction(name);
+
+    ComponentTypeInfo *registered = &(mComponentTypes[name] = type);
+    if (typeID != NoTypeID)
     {
-        if (name == mComponentCreationFunctionNames[f])
-            return mComponentCreationFunctions[f];
+        if (typeID >= mComponentTypesByID.size())
+            mComponentTypesByID.resize(typeID+1, NULL);
+        mComponentTypesByID[typeID] = registered;
     }
+}
 
-    return NULL;
+ComponentTypeInfo *SceneManager::getComponentType(Symbol name)
+{
+    std::unordered_map <Symbol, ComponentTypeInfo, Symbol::Hash>::iterator type = mComponentTypes.find(name);
+    return type != mComponentTypes.end() ? &type->second : NULL;
+}
+
+ComponentTypeInfo *SceneManager::getComponentType(unsigned int typeID)
+{
+    return typeID < mComponentTypesByID.size() ? mComponentTypesByID[typeID] : NULL;
+}
+
+void SceneManager::removeComponentCreationFunction(Symbol name)
+{
+    ComponentTypeInfo *type = getComponentType(name);
+    if (!type)
+        return;
+
+    if (type->mTypeID < mComponentTypesByID.size() && mComponentTypesByID[type->mTypeID] == type)
+        mComponentTypesByID[type->mTypeID] = NULL;
+    mComponentTypes.erase(name);
+}
+
+ComponentCreationFunction SceneManager::getComponentCreationFunction(Symbol name)
+{
+    ComponentTypeInfo *type = getComponentType(name);
+    return type ? type->mCreationFunction : NULL;
 }
 
 void SceneManager::saveGameObject(GameObject *object, std::string fileName)
@@ -90,6 +196,8 @@ GameObject *SceneManager::loadGameObject(std::string fileName)
 {
     std::ifstream file(fileName.c_str(), std::ios::in|std::ios::binary);
 
+    // A loaded object is a new object, so it doesn't keep the ID it was saved with. It joins the scene before its
+    // components are made, since pooled ones live in the scene's pools
     GameObject *object = createGameObject();
     sf::Packet packet;
 
@@ -104,7 +212,9 @@ GameObject *SceneManager::loadGameObject(std::string fileName)
     packet.append(buffer, size);
     delete buffer;
 
-    object->deserialize(packet);
+    int savedID;
+    packet >> savedID;
+    object->deserializeComponents(packet);
 
     packet.clear();
     file.close();
@@ -0,0 +1,95 @@
+/*
+SpatialHash.cpp
+Theodore DeRego
+Copyright 2012
+
+SpatialHash implementation
+*/
+
+#include "Scene/SpatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize)
+{
+    mCellSize = cellSize;
+}
+
+SpatialHash::~SpatialHash()
+{
+    //dtor
+}
+
+void SpatialHash::clear()
+{
+    mEntries.clear();
+}
+
+void SpatialHash::insert(unsigned int index, sf::Vector2f position)
+{
+    Entry entry;
+    entry.mCell = 0;
+    entry.mIndex = index;
+    entry.mPosition = position;
+    mEntries.push_back(entry);
+}
+
+void SpatialHash::build()
+{
+    for (unsigned int e = 0; e < mEntries.size(); e++)
+        mEntries[e].mCell = getCellKey(getCellCoordinate(mEntries[e].mPosition.x), getCellCoordinate(mEntries[e].mPosition.y));
+
+    std::sort(mEntries.begin(), mEntries.end());
+}
+
+void SpatialHash::query(sf::Vector2f center, float radius, std::vector <unsigned int> &indices)
+{
+    float radiusSq = radius*radius;
+
+    int firstColumn = getCellCoordinate(center.x-radius);
+    int lastColumn = getCellCoordinate(center.x+radius);
+    int firstRow = getCellCoordinate(center.y-radius);
+    int lastRow = getCellCoordinate(center.y+radius);
+
+    // A circle wider than there are entries is quicker to check against everything
+    if ((long long)lastColumn-firstColumn >= (long long)mEntries.size())
+    {
+        for (unsigned int e = 0; e < mEntries.size(); e++)
+        {
+            sf::Vector2f offset = mEntries[e].mPosition-center;
+            if (offset.x*offset.x+offset.y*offset.y <= radiusSq)
+                indices.push_back(mEntries[e].mIndex);
+        }
+
+        return;
+    }
+
+    Entry key;
+    for (int column = firstColumn; column <= lastColumn; column++)
+    {
+        // The rows of a column are one run of entries
+        key.mCell = getCellKey(column, firstRow);
+        sf::Uint64 lastCell = getCellKey(column, lastRow);
+
+        for (std::vector <Entry>::iterator entry = std::lower_bound(mEntries.begin(), mEntries.end(), key);
+             entry != mEntries.end() && entry->mCell <= lastCell; entry++)
+        {
+            sf::Vector2f offset = entry->mPosition-center;
+            if (offset.x*offset.x+offset.y*offset.y <= radiusSq)
+                indices.push_back(entry->mIndex);
+        }
+    }
+}
+
+int SpatialHash::getCellCoordinate(float position)
+{
+    // Far enough out that nothing real is there, and the keys can't overflow
+    float cell = std::floor(position/mCellSize);
+    if (!(cell > -1073741824.f)) // NaN too
+        return -1073741824;
+    if (cell > 1073741824.f)
+        return 1073741824;
+
+    return (int)cell;
+}
@@ -0,0 +1,132 @@
+/*
+UpdateScheduler.cpp
+Theodore DeRego
+Copyright 2012
+
+UpdateScheduler implementation
+*/
+
+#include "Scene/UpdateScheduler.h"
+
+#include <iostream>
+
+#include <SFML/System/Lock.hpp>
+
+#include "Core/Component.h"
+
+UpdateScheduler::UpdateScheduler()
+{
+    mTick = 0;
+    mTickLength = 0;
+}
+
+UpdateScheduler::~UpdateScheduler()
+{
+    //dtor
+}
+
+void UpdateScheduler::beginTick(float tickLength)
+{
+    mTick++;
+    mTickLength = tickLength;
+
+    for (std::unordered_map <Symbol, Budget, Symbol::Hash>::iterator b = mBudgets.begin(); b != mBudgets.end(); b++)
+        b->second.mTime = 0;
+}
+
+void UpdateScheduler::endTick()
+{
+    for (std::unordered_map <Symbol, Budget, Symbol::Hash>::iterator b = mBudgets.begin(); b != mBudgets.end(); b++)
+    {
+        Budget &budget = b->second;
+        budget.mLastTime = budget.mTime;
+
+        // Back off quickly when over budget and speed back up slowly once there's plenty of room
+        if (budget.mTime > budget.mBudget && budget.mSlowdown < MaxSlowdown)
+            budget.mSlowdown *= 2;
+        else if (budget.mTime < budget.mBudget/4 && budget.mSlowdown > 1)
+            budget.mSlowdown /= 2;
+    }
+}
+
+bool UpdateScheduler::isDue(Component *component, float dt, float &time)
+{
+    unsigned int interval = 1;
+    if (component->getUpdateRate() > 0 && mTickLength > 0)
+    {
+        interval = (unsigned int)(1.f/(component->getUpdateRate()*mTickLength)+0.5f);
+        if (interval < 1)
+            interval = 1;
+    }
+
+    if (!mBudgets.empty())
+    {
+        Budget *budget = findBudget(component);
+        if (budget)
+            interval *= budget->mSlowdown;
+    }
+
+    // The handle index is different for every live component, so it spreads components with the same interval
+    // evenly across the ticks
+    if (interval > 1 && (mTick+component->getHandle().mIndex)%interval != 0)
+    {
+        component->addSkippedTime(dt);
+        return false;
+    }
+
+    time = component->takeSkippedTime()+dt;
+    return true;
+}
+
+void UpdateScheduler::setBudget(Symbol typeName, float milliseconds)
+{
+    Budget budget;
+    budget.mBudget = milliseconds;
+    budget.mTime = 0;
+    budget.mLastTime = 0;
+    budget.mSlowdown = 1;
+
+    mBudgets[typeName] = budget;
+}
+
+void UpdateScheduler::removeBudget(Symbol typeName)
+{
+    mBudgets.erase(typeName);
+}
+
+void UpdateScheduler::printReport()
+{
+    for (std::unordered_map <Symbol, Budget, Symbol::Hash>::iterator b = mBudgets.begin(); b != mBudgets.end(); b++)
+    {
+        std::cout << b->first.getString() << ": " << b->second.mLastTime << "ms of " << b->second.mBudget << "ms";
+        if (b->second.mSlowdown > 1)
+            std::cout << ", updating " << b->second.mSlowdown << "x less often";
+        std::cout << std::endl;
+    }
+}
+
+UpdateScheduler::Budget *UpdateScheduler::findBudget(Component *component)
+{
+    std::unordered_map <Symbol, Budget, Symbol::Hash>::iterator budget = mBudgets.find(component->getTypeName());
+    return budget != mBudgets.end() ? &budget->second : NULL;
+}
+
+UpdateScheduler::Timer::Timer(UpdateScheduler *scheduler, Component *component)
+{
+    mScheduler = scheduler;
+    mBudget = (scheduler && !scheduler->mBudgets.empty()) ? scheduler->findBudget(component) : NULL;
+
+    if (mBudget)
+        mStart = scheduler->mClock.getElapsedTime();
+}
+
+UpdateScheduler::Timer::~Timer()
+{
+    if (!mBudget)
+        return;
+
+    float time = (mScheduler->mClock.getElapsedTime()-mStart).asMicroseconds()/1000.f;
+
+    sf::Lock lock(mScheduler->mBudgetMutex);
+    mBudget->mTime += time;
+}